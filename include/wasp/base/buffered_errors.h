@@ -0,0 +1,69 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_BUFFERED_ERRORS_H_
+#define WASP_BASE_BUFFERED_ERRORS_H_
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "wasp/base/errors.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+
+namespace wasp {
+
+// Records errors and context changes so they can be replayed later into
+// another Errors object. This is used when work is split across threads, so
+// each thread can report errors without synchronization, and the errors can
+// then be reported in a deterministic order.
+class BufferedErrors : public Errors {
+ public:
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  explicit BufferedErrors(bool has_context = true) : Errors{has_context} {}
+
+  bool HasError() const override { return has_error_; }
+
+  // The number of recorded events. This can be used to mark a position in the
+  // buffer, to replay only part of it.
+  size_t size() const { return events_.size(); }
+
+  // Replay the events in the range [begin, end) into `errors`.
+  void ReplayInto(Errors& errors, size_t begin = 0, size_t end = npos) const;
+
+ protected:
+  void HandlePushContext(Location loc, string_view desc) override;
+  void HandlePopContext() override;
+  void HandleOnError(Location loc, string_view message) override;
+
+ private:
+  enum class EventKind { PushContext, PopContext, Error };
+
+  struct Event {
+    EventKind kind;
+    Location loc;
+    std::string text;
+  };
+
+  std::vector<Event> events_;
+  bool has_error_ = false;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_BUFFERED_ERRORS_H_
@@ -0,0 +1,76 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_COMPACT_LOCATION_H_
+#define WASP_BASE_COMPACT_LOCATION_H_
+
+#include <limits>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// A Location stored as an offset and size relative to a base span, typically
+// the data of the module being read. On 64-bit platforms this is half the size
+// of a Location, but it must be resolved against the same base before use.
+//
+// A Location with no data, or one outside of the base, is stored as an invalid
+// CompactLocation, which resolves to an empty Location. An empty Location
+// inside the base keeps its offset, since errors such as "Expected final end"
+// are reported at an empty position in the data.
+struct CompactLocation {
+  static constexpr u32 kInvalidOffset = std::numeric_limits<u32>::max();
+
+  CompactLocation() = default;
+  explicit CompactLocation(u32 offset, u32 size)
+      : offset{offset}, size{size} {}
+  explicit CompactLocation(SpanU8 base, Location);
+
+  bool is_valid() const { return offset != kInvalidOffset; }
+  auto ToLocation(SpanU8 base) const -> Location;
+
+  u32 offset = kInvalidOffset;
+  u32 size = 0;
+};
+
+inline CompactLocation::CompactLocation(SpanU8 base, Location loc) {
+  if (loc.data() != nullptr && loc.begin() >= base.begin() &&
+      loc.end() <= base.end() &&
+      base.size() < std::numeric_limits<u32>::max()) {
+    offset = static_cast<u32>(loc.begin() - base.begin());
+    size = static_cast<u32>(loc.size());
+  }
+}
+
+inline auto CompactLocation::ToLocation(SpanU8 base) const -> Location {
+  if (!is_valid() || offset > base.size() || size > base.size() - offset) {
+    return Location{};
+  }
+  return base.subspan(offset, size);
+}
+
+inline bool operator==(CompactLocation lhs, CompactLocation rhs) {
+  return lhs.offset == rhs.offset && lhs.size == rhs.size;
+}
+
+inline bool operator!=(CompactLocation lhs, CompactLocation rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_COMPACT_LOCATION_H_
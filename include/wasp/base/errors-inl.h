@@ -17,11 +17,15 @@
 namespace wasp {
 
 inline void Errors::PushContext(Location loc, string_view desc) {
-  HandlePushContext(loc, desc);
+  if (has_context_) {
+    HandlePushContext(loc, desc);
+  }
 }
 
 inline void Errors::PopContext() {
-  HandlePopContext();
+  if (has_context_) {
+    HandlePopContext();
+  }
 }
 
 inline void Errors::OnError(Location loc, string_view message) {
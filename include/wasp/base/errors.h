@@ -31,10 +31,21 @@ class Errors {
 
   virtual bool HasError() const = 0;
 
+  // Context is pushed and popped for nearly every item that is read, so an
+  // Errors object that ignores context can disable it to avoid the virtual
+  // calls entirely. This is useful when reading trusted input.
+  bool has_context() const { return has_context_; }
+
  protected:
+  Errors() = default;
+  explicit Errors(bool has_context) : has_context_{has_context} {}
+
   virtual void HandlePushContext(Location loc, string_view desc) = 0;
   virtual void HandlePopContext() = 0;
   virtual void HandleOnError(Location loc, string_view message) = 0;
+
+ private:
+  bool has_context_ = true;
 };
 
 }  // namespace wasp
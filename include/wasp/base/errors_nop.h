@@ -21,8 +21,12 @@
 
 namespace wasp {
 
+// Ignores all errors and context. Use this when reading input that is known
+// to be valid, e.g. a module that was already validated.
 class ErrorsNop : public Errors {
  public:
+  ErrorsNop() : Errors{false} {}
+
   bool HasError() const override { return false; }
 
  protected:
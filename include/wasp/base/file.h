@@ -21,6 +21,7 @@
 
 #include "wasp/base/buffer.h"
 #include "wasp/base/optional.h"
+#include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
 
@@ -28,6 +29,48 @@ namespace wasp {
 
 optional<Buffer> ReadFile(string_view filename);
 
+// Hint for how the contents of a MappedFile will be accessed.
+enum class FileAccess {
+  Normal,
+  Sequential,
+  Random,
+};
+
+// An owning, read-only view of a file's contents. Regular files are memory
+// mapped; anything that can't be mapped (pipes, character devices, stdin) is
+// read into a Buffer instead. Either way the contents are exposed as a SpanU8
+// that remains valid for the lifetime of the MappedFile.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(MappedFile&&);
+  MappedFile& operator=(MappedFile&&);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  auto span() const -> SpanU8 { return span_; }
+  bool is_mapped() const { return mapped_; }
+
+  // Change the access hint after the file has been opened. Does nothing if
+  // the file is not mapped.
+  void Advise(FileAccess);
+
+ private:
+  friend optional<MappedFile> MapFile(string_view, FileAccess);
+
+  void Reset();
+
+  SpanU8 span_;
+  bool mapped_ = false;
+  Buffer buffer_;
+};
+
+// Open `filename` and map its contents into memory. The filename "-" reads
+// from stdin.
+optional<MappedFile> MapFile(string_view filename,
+                             FileAccess access = FileAccess::Normal);
+
 }  // namespace wasp
 
 #endif  // WASP_BASE_FILE_H_
@@ -0,0 +1,78 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_PARALLEL_FOR_H_
+#define WASP_BASE_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// Call `func(index, worker)` for every index in [0, count), using up to
+// `jobs` threads (including the calling thread). Indexes are handed out in
+// small batches, so the order in which they are visited is unspecified; `func`
+// must be safe to call concurrently for different indexes.
+//
+// `worker` is in [0, jobs) and is unique to the calling thread, so it can be
+// used to look up per-thread state.
+template <typename F>
+void ParallelFor(Index count, int jobs, F&& func) {
+  constexpr Index kBatchSize = 16;
+  const Index batch_count = (count + kBatchSize - 1) / kBatchSize;
+  const Index thread_count =
+      std::min(static_cast<Index>(std::max(jobs, 1)), batch_count);
+
+  if (thread_count <= 1) {
+    for (Index i = 0; i < count; ++i) {
+      func(i, 0);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  auto worker = [&](Index worker_index) {
+    for (;;) {
+      size_t begin = next.fetch_add(kBatchSize, std::memory_order_relaxed);
+      if (begin >= count) {
+        break;
+      }
+      auto end =
+          static_cast<Index>(std::min<size_t>(begin + kBatchSize, count));
+      for (Index i = static_cast<Index>(begin); i < end; ++i) {
+        func(i, worker_index);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (Index i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_PARALLEL_FOR_H_
@@ -0,0 +1,75 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_CODE_INDEX_H_
+#define WASP_BINARY_CODE_INDEX_H_
+
+#include <vector>
+
+#include "wasp/base/at.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+class LazyModule;
+struct ReadCtx;
+
+/// ---
+// An index of the function bodies in a Code section, so a body can be found
+// without reading all of the bodies before it. Building the index reads only
+// the size prefix of each body; locals and instructions are not decoded.
+//
+// Function indexes include imported functions, so the first body in the
+// section belongs to function `imported_function_count()`.
+class CodeIndex {
+ public:
+  CodeIndex() = default;
+  explicit CodeIndex(SpanU8 section_data,
+                     ReadCtx&,
+                     Index imported_function_count = 0);
+
+  Index imported_function_count() const;
+  Index size() const;
+  bool empty() const;
+  bool has_function(Index func_index) const;
+
+  // The full entry for a function body, including its size prefix.
+  auto GetLocation(Index func_index) const -> optional<Location>;
+
+  // The function body, after the size prefix. This includes the locals.
+  auto GetBody(Index func_index) const -> optional<SpanU8>;
+
+  // Read the locals of a function body. The result is identical to the value
+  // read by iterating over the Code section.
+  auto GetCode(Index func_index, ReadCtx&) const -> OptAt<Code>;
+
+ private:
+  SpanU8 data_;
+  Index imported_function_count_ = 0;
+  // Offsets of each entry relative to `data_`, plus the end of the last one.
+  std::vector<u32> offsets_;
+};
+
+// Build a CodeIndex for the module's Code section. Returns an empty index if
+// the module has no Code section.
+auto ReadCodeIndex(LazyModule&) -> CodeIndex;
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_CODE_INDEX_H_
@@ -59,6 +59,7 @@ WASP_BINARY_STRUCTS_CUSTOM_FORMAT(WASP_DECLARE_FORMATTER)
 WASP_DECLARE_FORMATTER(binary::Module)
 
 WASP_DECLARE_FORMATTER(binary::InstructionList)
+WASP_DECLARE_FORMATTER(binary::PackedExpression)
 
 }  // namespace binary
 }  // namespace wasp
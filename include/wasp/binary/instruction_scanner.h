@@ -0,0 +1,143 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_INSTRUCTION_SCANNER_H_
+#define WASP_BINARY_INSTRUCTION_SCANNER_H_
+
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/base/wasm_types.h"
+#include "wasp/binary/read/opcode_table.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+/// ---
+// Walks the instructions of an expression without building an Instruction
+// for each one. Immediates are skipped, and can be decoded on demand with the
+// accessors below, so a caller only pays for the immediates it uses.
+//
+//   InstructionScanner scanner{body, ctx};
+//   while (scanner.Next()) {
+//     if (scanner.opcode() == Opcode::Call) {
+//       ... scanner.index_immediate() ...
+//     }
+//   }
+//
+// The scanner produces the same sequence of opcodes as ReadExpression, and
+// reports the same errors for malformed encodings. It does not check that
+// else, catch and end instructions are properly nested, and it does not check
+// the value of LEB128 immediates that it only skips (e.g. reserved bytes, or
+// padding bits in the last byte).
+class InstructionScanner {
+ public:
+  explicit InstructionScanner(SpanU8 data, ReadCtx&);
+
+  // Move to the next instruction. Returns false at the end of the data, or if
+  // the instruction is malformed; in that case the error is reported to
+  // `ctx.errors`.
+  bool Next();
+
+  auto opcode() const -> Opcode { return opcode_; }
+  auto immediate_kind() const -> ImmediateKind { return immediate_kind_; }
+
+  // The encoded instruction, including its immediates.
+  auto instruction() const -> SpanU8 { return instruction_; }
+  // The encoded immediates only.
+  auto immediate() const -> SpanU8 { return immediate_; }
+  // The offset of the instruction, relative to the start of the data.
+  auto offset() const -> span_extent_t {
+    return instruction_.data() - data_start_;
+  }
+
+  // The first index immediate. Valid for the Index, DataDrop, FuncBind,
+  // BrOnExn, CallIndirect and BrOnCast immediate kinds.
+  auto index_immediate() const -> Index;
+
+  // Valid for the MemArg immediate kind.
+  auto memarg_immediate() const -> MemArgImmediate;
+
+  // Call `func(Index)` for each target of a br_table instruction, and return
+  // the default target.
+  template <typename F>
+  auto ForEachBrTableTarget(F&& func) const -> Index;
+
+ private:
+  static auto DecodeU32(const u8** ptr) -> u32;
+
+  bool ReadOpcode();
+  bool SkipImmediate();
+  bool OnError(const u8* instruction_start);
+
+  ReadCtx& ctx_;
+  // Immediates that can't be skipped cheaply are read with `quiet_ctx_`. If
+  // that fails, the instruction is read again with `ctx_` to report the error.
+  ErrorsNop errors_nop_;
+  ReadCtx quiet_ctx_;
+  const OpcodeTable& table_;
+  const u8* data_start_;
+  SpanU8 data_;
+  SpanU8 instruction_;
+  SpanU8 immediate_;
+  Opcode opcode_{};
+  ImmediateKind immediate_kind_ = ImmediateKind::None;
+  Index block_depth_ = 0;
+  bool seen_final_end_ = false;
+};
+
+// Decode a u32 LEB128 value that is known to be well-formed, i.e. it has
+// already been skipped by the scanner.
+inline auto InstructionScanner::DecodeU32(const u8** ptr) -> u32 {
+  const u8* p = *ptr;
+  u32 result = 0;
+  int shift = 0;
+  u8 byte;
+  do {
+    byte = *p++;
+    result |= u32(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  *ptr = p;
+  return result;
+}
+
+inline auto InstructionScanner::index_immediate() const -> Index {
+  const u8* ptr = immediate_.data();
+  return DecodeU32(&ptr);
+}
+
+inline auto InstructionScanner::memarg_immediate() const -> MemArgImmediate {
+  const u8* ptr = immediate_.data();
+  u32 align_log2 = DecodeU32(&ptr);
+  u32 offset = DecodeU32(&ptr);
+  return MemArgImmediate{align_log2, offset};
+}
+
+template <typename F>
+auto InstructionScanner::ForEachBrTableTarget(F&& func) const -> Index {
+  const u8* ptr = immediate_.data();
+  Index count = DecodeU32(&ptr);
+  for (Index i = 0; i < count; ++i) {
+    func(Index{DecodeU32(&ptr)});
+  }
+  return DecodeU32(&ptr);
+}
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_INSTRUCTION_SCANNER_H_
@@ -0,0 +1,115 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_MODULE_STREAM_H_
+#define WASP_BINARY_MODULE_STREAM_H_
+
+#include <memory>
+#include <vector>
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp::binary {
+
+// Splits a module that arrives in arbitrarily sized chunks into pieces that
+// can each be read on their own: the module header, each section, and for the
+// code section, each code body.
+//
+// All bytes are copied into storage owned by the ModuleStream, and stay valid
+// for its lifetime. Each section is given its own allocation, so a Location
+// read from one piece remains valid as more data arrives, but is not
+// contiguous with the Locations of other sections.
+//
+// A section's storage is allocated once its length is known, so a section
+// that declares a length larger than `max_section_size` is not buffered.
+// Instead, only its header is produced, as a SectionTooLarge item.
+class ModuleStream {
+ public:
+  // The same as the maximum module size of most engines.
+  static constexpr size_t kDefaultMaxSectionSize = 1024 * 1024 * 1024;
+
+  explicit ModuleStream(size_t max_section_size = kDefaultMaxSectionSize);
+
+  enum class ItemKind {
+    Header,            // The magic and version.
+    Section,           // A complete section other than the code section.
+    CodeSectionBegin,  // The code section; only its count is available.
+    Code,              // A complete code body, including its length prefix.
+    CodeSectionEnd,    // The code section; all bodies have been produced.
+    SectionTooLarge,   // The id and length of a section that is too large.
+  };
+
+  struct Item {
+    ItemKind kind;
+    SpanU8 data;
+  };
+
+  // Provide more data. The data is only borrowed until Next() returns nullopt,
+  // so Next() must be called until then before calling Append() again.
+  void Append(SpanU8);
+
+  // Signal that there is no more data. Any partial item is produced as-is by
+  // Next(), so the reader can report an error for it.
+  void Finish();
+
+  // Return the next complete item, or nullopt if more data is needed.
+  auto Next() -> optional<Item>;
+
+  // The number of bytes required before Next() can produce another item. This
+  // is a lower bound when the length of the next item is not yet known.
+  auto bytes_needed() const -> size_t;
+
+  auto max_section_size() const -> size_t { return max_section_size_; }
+
+  // True if Finish() was called and all items have been produced.
+  bool done() const { return state_ == State::Done; }
+
+ private:
+  enum class State { Header, SectionHeader, SectionBody, Done };
+
+  void TakeInput(size_t count);
+  auto TakePending() -> SpanU8;
+  auto Allocate(size_t size) -> u8*;
+  auto NextCode() -> optional<Item>;
+  auto unit() const -> SpanU8 { return SpanU8{unit_, unit_size_}; }
+  auto filled() const -> SpanU8 { return SpanU8{unit_, unit_filled_}; }
+
+  size_t max_section_size_;
+  State state_ = State::Header;
+  bool finished_ = false;
+  SpanU8 input_;
+
+  // The module header and section headers are collected here until their
+  // size is known.
+  Buffer pending_;
+
+  // The section currently being filled.
+  u8* unit_ = nullptr;
+  size_t unit_size_ = 0;
+  size_t unit_filled_ = 0;
+  bool is_code_ = false;
+  bool code_begun_ = false;
+  size_t code_pos_ = 0;
+
+  std::vector<std::unique_ptr<u8[]>> storage_;
+};
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_MODULE_STREAM_H_
@@ -0,0 +1,62 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/parallel_for.h"
+#include "wasp/binary/read/read_ctx.h"
+
+namespace wasp::binary {
+
+inline Index ParallelCodeSection::size() const {
+  return static_cast<Index>(codes_.size());
+}
+
+inline auto ParallelCodeSection::codes() const
+    -> const std::vector<At<Code>>& {
+  return codes_;
+}
+
+template <typename F>
+auto ParallelCodeSection::ForEach(int jobs, F&& func) -> optional<Index> {
+  const Index count = size();
+  std::vector<BufferedErrors> code_errors;
+  code_errors.reserve(count);
+  for (Index i = 0; i < count; ++i) {
+    code_errors.emplace_back(ctx_.errors.has_context());
+  }
+  // Not std::vector<bool>, since it is written concurrently.
+  std::vector<u8> code_ok(count, false);
+
+  ParallelFor(count, jobs, [&](Index index, Index worker) {
+    ReadCtx read_ctx{ctx_.features, code_errors[index]};
+    read_ctx.declared_data_count = ctx_.declared_data_count;
+    read_ctx.local_count = local_counts_[index];
+    code_ok[index] = func(index, worker, codes_[index], read_ctx);
+  });
+
+  size_t begin = 0;
+  for (Index index = 0; index < count; ++index) {
+    section_errors_.ReplayInto(ctx_.errors, begin, marks_[index]);
+    code_errors[index].ReplayInto(ctx_.errors);
+    begin = marks_[index];
+    if (!code_ok[index]) {
+      return index;
+    }
+  }
+  section_errors_.ReplayInto(ctx_.errors, begin);
+  return nullopt;
+}
+
+}  // namespace wasp::binary
@@ -0,0 +1,70 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_PARALLEL_CODE_SECTION_H_
+#define WASP_BINARY_PARALLEL_CODE_SECTION_H_
+
+#include <vector>
+
+#include "wasp/base/at.h"
+#include "wasp/base/buffered_errors.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+struct ReadCtx;
+
+// A Code section whose function bodies are read on several threads.
+//
+// The constructor splits the section serially, reading only the size and
+// locals of each body. ForEach then reads each body with its own ReadCtx and
+// BufferedErrors, and replays the buffered errors in function order, so they
+// are reported exactly as they would be by a serial read.
+class ParallelCodeSection {
+ public:
+  explicit ParallelCodeSection(SpanU8 section_data, ReadCtx&);
+
+  Index size() const;
+  auto codes() const -> const std::vector<At<Code>>&;
+
+  // Call `func(index, worker, code, read_ctx)` for each code, on up to `jobs`
+  // threads (see ParallelFor). `read_ctx` is set up to read the body of
+  // `code`, and its errors are buffered until `func` returns.
+  //
+  // `func` returns false to stop, as a serial visit stops at the first body
+  // that fails. In that case, errors are reported up to and including that
+  // body, and its index is returned. Otherwise all errors are reported, and
+  // nullopt is returned.
+  template <typename F>
+  auto ForEach(int jobs, F&& func) -> optional<Index>;
+
+ private:
+  ReadCtx& ctx_;
+  BufferedErrors section_errors_;
+  std::vector<At<Code>> codes_;
+  std::vector<u64> local_counts_;
+  // The errors for the i'th code's header end at section_errors_[marks_[i]].
+  std::vector<size_t> marks_;
+};
+
+}  // namespace wasp::binary
+
+#include "wasp/binary/parallel_code_section-inl.h"
+
+#endif  // WASP_BINARY_PARALLEL_CODE_SECTION_H_
@@ -29,8 +29,18 @@ namespace wasp::binary {
 
 struct ReadCtx;
 
-// Read a full binary module eagerly (see ReadLazyModule to read lazily).
-auto ReadModule(SpanU8, ReadCtx&) -> optional<Module>;
+// How ReadModule stores function bodies: as an InstructionList per function
+// in Module::codes, or as a PackedExpression per function in
+// Module::packed_codes.
+enum class CodeFormat { Unpacked, Packed };
+
+// Read a full binary module eagerly (see ReadLazyModule to read lazily). If
+// `jobs` is greater than 1, the function bodies are decoded on that many
+// threads; the result and the reported errors are the same either way.
+auto ReadModule(SpanU8,
+                ReadCtx&,
+                CodeFormat = CodeFormat::Unpacked,
+                int jobs = 1) -> optional<Module>;
 
 
 template <typename T>
@@ -52,6 +62,11 @@ auto ReadBytesExpected(SpanU8* data,
 // Read a byte without advancing the span.
 auto PeekU8(SpanU8*, ReadCtx&) -> OptAt<u8>;
 
+// Read an opcode using the decode table for `ctx.features`, returning the
+// opcode along with the kind of immediate that follows it.
+struct OpcodeInfo;
+auto ReadOpcodeInfo(SpanU8*, ReadCtx&) -> OptAt<OpcodeInfo>;
+
 // Functions to read a length/count. The difference is only in the error word
 // used. Both ReadCount and ReadLength forward to ReadCheckLength.
 auto ReadCount(SpanU8*, ReadCtx&) -> OptAt<Index>;
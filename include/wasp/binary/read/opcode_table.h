@@ -0,0 +1,115 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_READ_OPCODE_TABLE_H_
+#define WASP_BINARY_READ_OPCODE_TABLE_H_
+
+#include <array>
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/types.h"
+#include "wasp/base/wasm_types.h"
+
+namespace wasp::binary {
+
+// How Read<Instruction> reads the rest of an instruction after its opcode.
+// Most of these correspond to an immediate type, but some opcodes need extra
+// checks (e.g. End must match an open block), so they have their own kind.
+enum class ImmediateKind : u8 {
+  None,
+  End,
+  Else,
+  Catch,
+  HeapType,
+  Block,
+  DataDrop,
+  Index,
+  FuncBind,
+  BrOnExn,
+  BrTable,
+  CallIndirect,
+  MemArg,
+  Reserved,
+  I32Const,
+  I64Const,
+  F32Const,
+  F64Const,
+  V128Const,
+  MemoryInit,
+  TableInit,
+  MemoryCopy,
+  TableCopy,
+  Shuffle,
+  SelectT,
+  Lane,
+  Let,
+  StructField,
+  RttSub,
+  HeapType2,
+  BrOnCast,
+};
+
+auto GetImmediateKind(Opcode) -> ImmediateKind;
+
+struct OpcodeInfo {
+  enum class Kind : u8 { Invalid, Prefix, Opcode };
+
+  bool is_valid() const { return kind == Kind::Opcode; }
+  bool is_prefix() const { return kind == Kind::Prefix; }
+
+  Kind kind;
+  ImmediateKind immediate_kind;
+  Opcode opcode;
+};
+
+// Decode tables for all opcodes that are enabled by a given Features value:
+// a 256-entry table for the first byte, and one table per prefix byte,
+// indexed by the LEB128-encoded code that follows the prefix.
+//
+// Building the tables is relatively expensive, so use Get, which caches one
+// table per Features value. The cache is thread-safe.
+class OpcodeTable {
+ public:
+  explicit OpcodeTable(const Features&);
+
+  static auto Get(const Features&) -> const OpcodeTable&;
+
+  auto Lookup(u8 code) const -> OpcodeInfo { return primary_[code]; }
+  auto Lookup(u8 prefix, u32 code) const -> OpcodeInfo;
+
+ private:
+  static constexpr u8 kFirstPrefix = 0xfb;
+  static constexpr u8 kLastPrefix = 0xfe;
+  static constexpr int kPrefixCount = kLastPrefix - kFirstPrefix + 1;
+
+  std::array<OpcodeInfo, 256> primary_;
+  std::array<std::vector<OpcodeInfo>, kPrefixCount> prefixed_;
+};
+
+inline auto OpcodeTable::Lookup(u8 prefix, u32 code) const -> OpcodeInfo {
+  if (prefix >= kFirstPrefix && prefix <= kLastPrefix) {
+    const auto& table = prefixed_[prefix - kFirstPrefix];
+    if (code < table.size()) {
+      return table[code];
+    }
+  }
+  return OpcodeInfo{OpcodeInfo::Kind::Invalid, ImmediateKind::None, {}};
+}
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_READ_OPCODE_TABLE_H_
@@ -19,6 +19,7 @@
 
 #include "wasp/base/features.h"
 #include "wasp/base/optional.h"
+#include "wasp/binary/read/opcode_table.h"
 #include "wasp/binary/types.h"
 
 namespace wasp {
@@ -33,6 +34,10 @@ struct ReadCtx {
 
   void Reset();
 
+  // The decode table for the opcodes enabled by `features`. The table is
+  // cached, and looked up again only if `features` changes.
+  auto opcode_table() -> const OpcodeTable&;
+
   Features features;
   Errors& errors;
 
@@ -46,8 +51,20 @@ struct ReadCtx {
   u64 local_count = 0;
   std::vector<At<Opcode>> open_blocks;
   bool seen_final_end = false;
+
+ private:
+  const OpcodeTable* opcode_table_ = nullptr;
+  Features::Bits opcode_table_bits_ = 0;
 };
 
+inline auto ReadCtx::opcode_table() -> const OpcodeTable& {
+  if (!opcode_table_ || opcode_table_bits_ != features.bits()) {
+    opcode_table_ = &OpcodeTable::Get(features);
+    opcode_table_bits_ = features.bits();
+  }
+  return *opcode_table_;
+}
+
 }  // namespace binary
 }  // namespace wasp
 
@@ -54,6 +54,41 @@ OptAt<T> ReadVarInt(SpanU8* data, ReadCtx& ctx, string_view desc) {
   constexpr u8 kLastByteMask = ~((1 << kLastByteMaskBits) - 1);
   constexpr u8 kLastByteOnes = kLastByteMask & kByteMask;
 
+  // Fast path: nearly all LEB128 values in real modules are a single byte.
+  if (!data->empty() && ((*data)[0] & VarInt<T>::kExtendBit) == 0) {
+    const u8 byte = (*data)[0];
+    Location loc = data->first(1);
+    data->remove_prefix(1);
+    return At{loc, is_signed ? SignExtend<T>(byte, 6) : T(byte)};
+  }
+
+  // Fast path: if the longest possible encoding fits in the remaining data,
+  // decode without any bounds checks or error context. Anything malformed
+  // falls through to the checked loop below, which reports the error.
+  if (data->size() >= VarInt<T>::kMaxBytes) {
+    const u8* p = data->data();
+    U result{};
+    for (int i = 0; i < VarInt<T>::kMaxBytes - 1; ++i) {
+      const u8 byte = p[i];
+      result |= U(byte & kByteMask) << (i * 7);
+      if ((byte & VarInt<T>::kExtendBit) == 0) {
+        Location loc = data->first(i + 1);
+        data->remove_prefix(i + 1);
+        return At{loc, is_signed ? SignExtend<T>(result, 6 + i * 7)
+                                 : T(result)};
+      }
+    }
+    constexpr int kLast = VarInt<T>::kMaxBytes - 1;
+    const u8 byte = p[kLast];
+    if ((byte & kLastByteMask) == 0 ||
+        (is_signed && (byte & kLastByteMask) == kLastByteOnes)) {
+      result |= U(byte & kByteMask) << (kLast * 7);
+      Location loc = data->first(kLast + 1);
+      data->remove_prefix(kLast + 1);
+      return At{loc, T(result)};
+    }
+  }
+
   ErrorsContextGuard error_guard{ctx.errors, *data, desc};
   LocationGuard guard{data};
 
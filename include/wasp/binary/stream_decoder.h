@@ -0,0 +1,255 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_STREAM_DECODER_H_
+#define WASP_BINARY_STREAM_DECODER_H_
+
+#include <cassert>
+
+#include "wasp/base/concat.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/features.h"
+#include "wasp/base/macros.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/module_stream.h"
+#include "wasp/binary/sections.h"
+#include "wasp/binary/visitor.h"
+
+namespace wasp::binary::visit {
+
+// Visits a module as it arrives, rather than requiring the whole module up
+// front. The visitor receives the same callbacks as visit::Visit, and each
+// section is visited as soon as it is complete. The code section is visited
+// one body at a time, so instructions can be validated while later bodies are
+// still being received.
+//
+// The LazyCodeSection passed to BeginCodeSection has a valid count, but its
+// sequence must not be iterated until EndCodeSection, since the bodies may not
+// have arrived yet.
+//
+// Sections larger than `max_section_size` are rejected with an error before
+// any storage is allocated for them; see ModuleStream.
+template <typename Visitor>
+class StreamDecoder {
+ public:
+  explicit StreamDecoder(
+      const Features&,
+      Errors&,
+      Visitor&,
+      size_t max_section_size = ModuleStream::kDefaultMaxSectionSize);
+
+  // Provide more of the module, and visit everything that is now complete.
+  Result Append(SpanU8);
+
+  // Signal the end of the module, and finish visiting it.
+  Result Finish();
+
+  // The number of bytes required before more of the module can be visited.
+  // This is a lower bound if the size of the next item isn't known yet.
+  auto bytes_needed() const -> size_t;
+
+  // The module being read. This is only available once the module header has
+  // been received.
+  auto module() -> LazyModule* { return module_ ? &*module_ : nullptr; }
+
+ private:
+  Result Drain();
+  Result VisitItem(const ModuleStream::Item&);
+  Result VisitCodeItem(SpanU8);
+  void CheckCodeCount(SpanU8);
+
+  Features features_;
+  Errors& errors_;
+  Visitor& visitor_;
+  ModuleStream stream_;
+  optional<LazyModule> module_;
+  optional<Result> result_;
+
+  // Code section state.
+  optional<LazyCodeSection> code_section_;
+  bool skip_code_ = false;
+  bool code_failed_ = false;
+  Index code_count_ = 0;
+};
+
+template <typename Visitor>
+StreamDecoder<Visitor>::StreamDecoder(const Features& features,
+                                      Errors& errors,
+                                      Visitor& visitor,
+                                      size_t max_section_size)
+    : features_{features},
+      errors_{errors},
+      visitor_{visitor},
+      stream_{max_section_size} {}
+
+template <typename Visitor>
+Result StreamDecoder<Visitor>::Append(SpanU8 data) {
+  if (result_) {
+    return *result_;
+  }
+  stream_.Append(data);
+  return Drain();
+}
+
+template <typename Visitor>
+Result StreamDecoder<Visitor>::Finish() {
+  if (result_) {
+    return *result_;
+  }
+  stream_.Finish();
+  auto res = Drain();
+  if (res != Result::Ok) {
+    return res;
+  }
+  assert(module_.has_value());
+  EndModule(module_->data, module_->ctx);
+  result_ = visitor_.EndModule(*module_);
+  return *result_;
+}
+
+template <typename Visitor>
+auto StreamDecoder<Visitor>::bytes_needed() const -> size_t {
+  return result_ ? 0 : stream_.bytes_needed();
+}
+
+template <typename Visitor>
+Result StreamDecoder<Visitor>::Drain() {
+  while (auto item = stream_.Next()) {
+    auto res = VisitItem(*item);
+    if (res != Result::Ok) {
+      result_ = res;
+      return res;
+    }
+  }
+  return Result::Ok;
+}
+
+template <typename Visitor>
+Result StreamDecoder<Visitor>::VisitItem(const ModuleStream::Item& item) {
+  using ItemKind = ModuleStream::ItemKind;
+
+  if (item.kind == ItemKind::Header) {
+    module_.emplace(item.data, features_, errors_);
+    if (!(module_->magic && module_->version)) {
+      return Result::Fail;
+    }
+    return visitor_.BeginModule(*module_);
+  }
+
+  assert(module_.has_value());
+  SpanU8 data = item.data;
+  switch (item.kind) {
+    case ItemKind::Section: {
+      auto section = Read<Section>(&data, module_->ctx);
+      if (!section) {
+        return Result::Fail;
+      }
+      auto res = VisitSection(*module_, *section, visitor_);
+      return res == Result::Fail ? Result::Fail : Result::Ok;
+    }
+
+    case ItemKind::CodeSectionBegin: {
+      // Only the section header and count have been received, but that is
+      // enough to read the section; its contents aren't accessed until the
+      // sequence is iterated.
+      auto section = Read<Section>(&data, module_->ctx);
+      if (!section) {
+        return Result::Fail;
+      }
+      code_section_.reset();
+      skip_code_ = false;
+      code_failed_ = false;
+      code_count_ = 0;
+
+      auto res = visitor_.OnSection(*section);
+      if (res != Result::Ok) {
+        skip_code_ = true;
+        return res == Result::Fail ? Result::Fail : Result::Ok;
+      }
+
+      code_section_.emplace(ReadCodeSection((*section)->known(), module_->ctx));
+      res = visitor_.BeginCodeSection(*code_section_);
+      if (res == Result::Skip) {
+        // If skipping this section, increment by the number of code items
+        // specified in this section.
+        skip_code_ = true;
+        module_->ctx.code_count += code_section_->count.value_or(0);
+        return Result::Ok;
+      }
+      return res;
+    }
+
+    case ItemKind::Code:
+      return VisitCodeItem(item.data);
+
+    case ItemKind::CodeSectionEnd:
+      if (skip_code_ || !code_section_) {
+        return Result::Ok;
+      }
+      if (!code_failed_) {
+        CheckCodeCount(item.data.last(0));
+      }
+      return visitor_.EndCodeSection(*code_section_);
+
+    case ItemKind::SectionTooLarge: {
+      // Only the section id and length have been received.
+      data = data.subspan(1);
+      auto length = Read<u32>(&data, module_->ctx);
+      assert(length.has_value());
+      errors_.OnError(item.data, concat("Section length ", **length,
+                                        " exceeds maximum ",
+                                        stream_.max_section_size()));
+      return Result::Fail;
+    }
+
+    default:
+      WASP_UNREACHABLE();
+  }
+}
+
+template <typename Visitor>
+Result StreamDecoder<Visitor>::VisitCodeItem(SpanU8 data) {
+  if (skip_code_ || code_failed_ || !code_section_) {
+    return Result::Ok;
+  }
+
+  SpanU8 copy = data;
+  auto code = Read<Code>(&copy, module_->ctx);
+  if (!code) {
+    // Stop reading code bodies, the same way that iterating a LazySequence
+    // would.
+    code_failed_ = true;
+    CheckCodeCount(data);
+    return Result::Ok;
+  }
+  code_count_++;
+  return VisitCode(*module_, *code, visitor_);
+}
+
+template <typename Visitor>
+void StreamDecoder<Visitor>::CheckCodeCount(SpanU8 data) {
+  auto expected = code_section_->count;
+  if (expected && *expected != code_count_) {
+    errors_.OnError(data, concat("Expected code section to have count ",
+                                 *expected, ", got ", code_count_));
+  }
+}
+
+}  // namespace wasp::binary::visit
+
+#endif  // WASP_BINARY_STREAM_DECODER_H_
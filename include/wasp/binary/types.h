@@ -23,6 +23,7 @@
 
 #include "wasp/base/absl_hash_value_macros.h"
 #include "wasp/base/at.h"
+#include "wasp/base/compact_location.h"
 #include "wasp/base/operator_eq_ne_macros.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
@@ -268,7 +269,7 @@ struct StructFieldImmediate {
 };
 
 // NOTE this must be kept in sync with the Instruction variant below.
-enum class InstructionKind {
+enum class InstructionKind : u8 {
   None,
   S32,
   S64,
@@ -655,6 +656,61 @@ struct UnpackedCode {
   UnpackedExpression body;
 };
 
+// A compact encoding of a decoded function body, as an alternative to
+// UnpackedExpression. Each At<Instruction> is over 200 bytes, and some own
+// vectors; here the instructions are instead stored as parallel arrays of
+// opcodes, locations and fixed-width immediates (~22 bytes per instruction).
+// Immediates that don't fit in 64 bits (br_table targets, block types, v128,
+// etc.) are stored in a shared side buffer.
+//
+// Locations are stored relative to `base`, typically the module data. Only
+// the locations of each instruction and its opcode are kept; an instruction
+// read back with operator[] uses the location of its whole immediate for each
+// of the immediate's fields.
+class PackedExpression {
+ public:
+  PackedExpression() = default;
+  explicit PackedExpression(SpanU8 base);
+  explicit PackedExpression(SpanU8 base, const InstructionList&);
+
+  SpanU8 base() const;
+  Index size() const;
+  bool empty() const;
+  void reserve(Index count);
+  void push_back(const At<Instruction>&);
+
+  auto opcode(Index) const -> Opcode;
+  auto kind(Index) const -> InstructionKind;
+  auto loc(Index) const -> Location;
+  auto operator[](Index) const -> At<Instruction>;
+
+  auto ToInstructionList() const -> InstructionList;
+
+  // Locations are not compared or hashed.
+  friend bool operator==(const PackedExpression&, const PackedExpression&);
+  friend bool operator!=(const PackedExpression&, const PackedExpression&);
+
+  template <typename H>
+  friend H AbslHashValue(H h, const PackedExpression& v) {
+    return H::combine(std::move(h), v.opcodes_, v.kinds_, v.immediates_,
+                      v.extra_);
+  }
+
+ private:
+  SpanU8 base_;
+  std::vector<Opcode> opcodes_;
+  std::vector<InstructionKind> kinds_;
+  std::vector<u8> opcode_sizes_;
+  std::vector<CompactLocation> locs_;
+  std::vector<u64> immediates_;
+  std::vector<u32> extra_;
+};
+
+struct PackedCode {
+  LocalsList locals;
+  PackedExpression body;
+};
+
 // Section 11: Data
 
 struct DataSegment {
@@ -702,6 +758,8 @@ struct Module {
   optional<At<DataCount>> data_count;
   std::vector<At<UnpackedCode>> codes;
   std::vector<At<DataSegment>> data_segments;
+  // Used instead of `codes` when read with CodeFormat::Packed.
+  std::vector<At<PackedCode>> packed_codes;
 };
 
 #define WASP_BINARY_ENUMS(WASP_V) \
@@ -745,6 +803,7 @@ struct Module {
   WASP_V(binary::Locals, 2, count, type)                                 \
   WASP_V(binary::MemArgImmediate, 2, align_log2, offset)                 \
   WASP_V(binary::Memory, 1, memory_type)                                 \
+  WASP_V(binary::PackedCode, 2, locals, body)                            \
   WASP_V(binary::RefType, 2, heap_type, null)                            \
   WASP_V(binary::ReferenceType, 1, type)                                 \
   WASP_V(binary::Rtt, 2, depth, type)                                    \
@@ -321,6 +321,27 @@ Iterator Write(const UnpackedCode& value, Iterator out) {
   return out;
 }
 
+template <typename Iterator>
+Iterator Write(const PackedExpression& value, Iterator out) {
+  for (Index i = 0; i < value.size(); ++i) {
+    out = Write(*value[i], out);
+  }
+  return out;
+}
+
+template <typename Iterator>
+Iterator Write(const PackedCode& value, Iterator out) {
+  // Write Code to a separate buffer, so we know its length.
+  Buffer buffer;
+  auto code_out = std::back_inserter(buffer);
+  code_out = WriteVector(value.locals.begin(), value.locals.end(), code_out);
+  code_out = Write(value.body, code_out);
+
+  // Then write that buffer to the real output.
+  out = WriteLengthAndBytes(buffer, out);
+  return out;
+}
+
 template <typename Iterator>
 Iterator Write(const ConstantExpression& value, Iterator out) {
   out = Write(value.instructions, out);
@@ -771,7 +792,13 @@ Iterator Write(const Module& value, Iterator out) {
   out = WriteNonEmptyKnownSection(SectionId::Start, value.start, out);
   out = WriteNonEmptyKnownSection(SectionId::Element, value.element_segments, out);
   out = WriteNonEmptyKnownSection(SectionId::DataCount, value.data_count, out);
-  out = WriteNonEmptyKnownSection(SectionId::Code, value.codes, out);
+  // A Module is read with either `codes` or `packed_codes`, never both.
+  assert(value.codes.empty() || value.packed_codes.empty());
+  if (value.packed_codes.empty()) {
+    out = WriteNonEmptyKnownSection(SectionId::Code, value.codes, out);
+  } else {
+    out = WriteNonEmptyKnownSection(SectionId::Code, value.packed_codes, out);
+  }
   out = WriteNonEmptyKnownSection(SectionId::Data, value.data_segments, out);
   return out;
 }
@@ -113,6 +113,8 @@ auto ToText(TextCtx&, const binary::InstructionList&) -> text::InstructionList;
 auto ToText(TextCtx&, const At<binary::UnpackedExpression>&) -> text::InstructionList;
 auto ToText(TextCtx&, const binary::LocalsList&) -> At<text::BoundValueTypeList>;
 auto ToText(TextCtx&, const At<binary::UnpackedCode>&, At<text::Function>&) -> At<text::Function>&;
+auto ToText(TextCtx&, const binary::PackedExpression&) -> text::InstructionList;
+auto ToText(TextCtx&, const At<binary::PackedCode>&, At<text::Function>&) -> At<text::Function>&;
 
 // Section 11: Data
 auto ToText(TextCtx&, const At<SpanU8>&) -> text::DataItemList;
@@ -18,9 +18,12 @@
 #include <array>
 #include <cassert>
 #include <charconv>
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <system_error>
 
-#include "absl/strings/numbers.h"
+#include "absl/strings/charconv.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 
@@ -44,6 +47,25 @@ inline bool IsDigit<16>(u8 c) {
          (c >= 'A' && c <= 'F');
 }
 
+// Returns true if all 8 bytes of `chunk` are decimal digits.
+inline bool IsEightDigits(u64 chunk) {
+  return ((chunk & 0xf0f0f0f0'f0f0f0f0ull) |
+          (((chunk + 0x06060606'06060606ull) & 0xf0f0f0f0'f0f0f0f0ull) >> 4)) ==
+         0x33333333'33333333ull;
+}
+
+// Returns the value of the 8 decimal digits in `chunk`, which was loaded from
+// memory in little-endian order, so the first digit is in the lowest byte.
+// Pairs of digits are combined, then pairs of pairs, using only 3 multiplies.
+inline u64 ParseEightDigits(u64 chunk) {
+  constexpr u64 mask = 0x000000ff'000000ffull;
+  constexpr u64 mul1 = 100 + (1000000ull << 32);
+  constexpr u64 mul2 = 1 + (10000ull << 32);
+  chunk -= 0x30303030'30303030ull;
+  chunk = (chunk * 10) + (chunk >> 8);
+  return (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+}
+
 template <typename T, int base>
 auto ParseInteger(SpanU8 span) -> optional<T> {
   static constexpr const u8 DigitToValue[256] = {
@@ -56,6 +78,40 @@ auto ParseInteger(SpanU8 span) -> optional<T> {
       0, 10, 11, 12, 13, 14, 15,
   };
 
+  // A u64 can't overflow with this many digits, so shorter literals (nearly
+  // all of them) are accumulated without checks, and compared against the
+  // maximum once at the end.
+  constexpr span_extent_t max_unchecked_digits = base == 10 ? 19 : 16;
+  if (span.size() <= max_unchecked_digits) {
+    const u8* ptr = span.data();
+    const u8* end = ptr + span.size();
+    u64 value = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if constexpr (base == 10) {
+      while (end - ptr >= 8) {
+        u64 chunk;
+        memcpy(&chunk, ptr, sizeof(chunk));
+        if (!IsEightDigits(chunk)) {
+          break;  // Underscores are handled below.
+        }
+        value = value * 100000000 + ParseEightDigits(chunk);
+        ptr += 8;
+      }
+    }
+#endif
+    for (; ptr < end; ++ptr) {
+      if (*ptr == '_') {
+        continue;
+      }
+      assert(IsDigit<base>(*ptr));
+      value = value * base + DigitToValue[*ptr];
+    }
+    if (value > std::numeric_limits<T>::max()) {
+      return nullopt;
+    }
+    return static_cast<T>(value);
+  }
+
   constexpr const T max_div_base = std::numeric_limits<T>::max() / base;
   constexpr const T max_mod_base = std::numeric_limits<T>::max() % base;
   T value = 0;
@@ -129,30 +185,56 @@ inline void RemoveUnderscores(SpanU8 span, Buffer& out) {
 }
 
 template <typename T>
-auto SimpleAto(const char* str, T* value) -> bool;
-
-template <>
-inline auto SimpleAto<f32>(const char* str, f32* value) -> bool {
-  // Abseil's float conversions will silently convert large values into `inf`,
-  // which is not allowed by the Wasm text format. This function will only be
-  // used for normal values, so we know that if an `inf` is returned it is
-  // invalid.
-  return absl::SimpleAtof(str, value) && !std::isinf(*value);
-}
+auto ParseFloat(SpanU8 span) -> optional<T> {
+  // absl::from_chars parses directly from the token, so a copy is only needed
+  // to remove underscores; short literals are copied to the stack.
+  constexpr span_extent_t max_inline_size = 64;
+  std::array<char, max_inline_size> inline_buffer;
+  Buffer buffer;
+  auto* begin = reinterpret_cast<const char*>(span.data());
+  auto* end = begin + span.size();
+  if (std::memchr(begin, '_', span.size()) != nullptr) {
+    if (span.size() <= max_inline_size) {
+      end = std::copy_if(begin, end, inline_buffer.data(),
+                         [](char c) { return c != '_'; });
+      begin = inline_buffer.data();
+    } else {
+      RemoveUnderscores(span, buffer);
+      begin = reinterpret_cast<const char*>(buffer.data());
+      end = begin + buffer.size();
+    }
+  }
 
-template <>
-inline auto SimpleAto<f64>(const char* str, f64* value) -> bool {
-  // See the comment in SimpleAto<f32> above.
-  return absl::SimpleAtod(str, value) && !std::isinf(*value);
-}
+  // absl::from_chars doesn't accept a sign or a "0x" prefix.
+  bool negate = false;
+  if (begin != end && (*begin == '+' || *begin == '-')) {
+    negate = *begin == '-';
+    ++begin;
+  }
+  auto format = absl::chars_format::general;
+  if (end - begin >= 2 && begin[0] == '0' &&
+      (begin[1] == 'x' || begin[1] == 'X')) {
+    format = absl::chars_format::hex;
+    begin += 2;
+  }
 
-template <typename T>
-auto ParseFloat(SpanU8 span) -> optional<T> {
+  // Decimal literals use the Eisel-Lemire algorithm, with an exact fallback;
+  // hex literals are assembled directly. Both round to nearest, ties to even.
   T value;
-  if (!SimpleAto(reinterpret_cast<const char*>(span.begin()), &value)) {
+  auto result = absl::from_chars(begin, end, value, format);
+  if (result.ptr != end) {
     return nullopt;
   }
-  return value;
+  if (result.ec == std::errc::result_out_of_range) {
+    // Values that are too large are not allowed by the Wasm text format, but
+    // values that are too small round to zero.
+    if (std::isinf(value) || std::abs(value) > 1) {
+      return nullopt;
+    }
+  } else if (result.ec != std::errc{} || std::isinf(value)) {
+    return nullopt;
+  }
+  return negate ? -value : value;
 }
 
 template <typename Float>
@@ -218,12 +300,8 @@ auto MakeNanPayload(Sign sign, typename FloatTraits<T>::Int payload) -> T {
 template <typename T>
 auto StrToFloat(LiteralInfo info, SpanU8 span) -> optional<T> {
   switch (info.kind) {
-    case LiteralKind::Normal: {
-      Buffer vec;
-      RemoveUnderscores(span, vec);  // Always need to copy, to null-terminate.
-      vec.push_back(0);
-      return ParseFloat<T>(vec);
-    }
+    case LiteralKind::Normal:
+      return ParseFloat<T>(span);
 
     case LiteralKind::Nan:
       return MakeNan<T>(info.sign);
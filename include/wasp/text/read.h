@@ -207,6 +207,15 @@ auto ReadModuleItem(Tokenizer&, ReadCtx&) -> OptAt<ModuleItem>;
 auto ReadModule(Tokenizer&, ReadCtx&) -> optional<Module>;
 auto ReadSingleModule(Tokenizer&, ReadCtx&) -> optional<Module>;
 
+// The same as ReadModule and ReadSingleModule, but if `jobs` is greater than
+// 1, the top-level fields are found with SplitSExpressions and read on `jobs`
+// threads, each with its own ReadCtx and BufferedErrors. The items and errors
+// are then collected in source order, so the result is the same as reading
+// serially.
+auto ReadModuleParallel(Tokenizer&, ReadCtx&, int jobs) -> optional<Module>;
+auto ReadSingleModuleParallel(Tokenizer&, ReadCtx&, int jobs)
+    -> optional<Module>;
+
 // Script
 
 auto ReadModuleVarOpt(Tokenizer&, ReadCtx&) -> OptAt<ModuleVar>;
@@ -17,6 +17,8 @@
 #ifndef WASP_TEXT_READ_LEX_H_
 #define WASP_TEXT_READ_LEX_H_
 
+#include <vector>
+
 #include "wasp/base/span.h"
 #include "wasp/text/read/token.h"
 
@@ -25,6 +27,13 @@ namespace wasp::text {
 auto Lex(SpanU8* data) -> Token;
 auto LexNoWhitespace(SpanU8* data) -> Token;
 
+// Splits `data` into its top-level s-expressions, by matching parentheses and
+// skipping strings and comments, but without lexing anything else. Stops at
+// the end of `data`, or at anything other than whitespace, a comment, or a
+// complete s-expression. This is much faster than lexing, so it can be used to
+// find independent pieces of a large module.
+auto SplitSExpressions(SpanU8 data) -> std::vector<SpanU8>;
+
 }  // namespace wasp::text
 
 #endif  // WASP_TEXT_READ_LEX_H_
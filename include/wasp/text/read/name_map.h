@@ -17,11 +17,21 @@
 #ifndef WASP_TEXT_READ_NAME_MAP_H_
 #define WASP_TEXT_READ_NAME_MAP_H_
 
+#include <vector>
+
+#include "wasp/base/hashmap.h"
 #include "wasp/base/string_view.h"
 #include "wasp/text/types.h"
 
 namespace wasp::text {
 
+// Maps names to indexes, with nested scopes for labels and let locals. Names
+// in the innermost scope have the lowest indexes; a name in an inner scope
+// shadows the same name in an outer one.
+//
+// Each name maps to its most recent position; positions that it shadows are
+// chained through `shadowed_`, and restored by Pop. So lookups don't depend
+// on the number of names.
 class NameMap {
  public:
   explicit NameMap();
@@ -39,10 +49,14 @@ class NameMap {
   auto Size() const -> Index;
 
  private:
-  optional<size_t> FindInRange(size_t begin, size_t end, BindVar) const;
+  static constexpr Index kNone = ~Index{0};
+
+  auto Find(BindVar) const -> Index;
 
   std::vector<optional<BindVar>> names_;
-  std::vector<size_t> stack_;
+  std::vector<Index> shadowed_;  // Parallel to names_.
+  std::vector<Index> stack_;     // The first position of each scope.
+  flat_hash_map<BindVar, Index> positions_;
 };
 
 }  // namespace wasp::text
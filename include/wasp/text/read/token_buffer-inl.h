@@ -0,0 +1,72 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+#include <cassert>
+
+namespace wasp::text {
+
+inline auto TokenBuffer::data() const -> SpanU8 {
+  return data_;
+}
+
+inline auto TokenBuffer::size() const -> Index {
+  return static_cast<Index>(tokens_.size());
+}
+
+inline bool TokenBuffer::is_buffered() const {
+  return !tokens_.empty();
+}
+
+inline auto TokenBuffer::Get(Index index) const -> Token {
+  assert(is_buffered());
+  const auto& packed = tokens_[std::min<size_t>(index, tokens_.size() - 1)];
+  Location loc = data_.subspan(packed.offset, packed.size);
+  auto type = static_cast<TokenType>(packed.type);
+  auto immediate = packed.immediate;
+
+  // Cases follow the order of the Token::Immediate alternatives, which is
+  // checked in token_buffer.cc.
+  switch (packed.immediate_index) {
+    case 1:
+      return Token{loc, type,
+                   OpcodeInfo{static_cast<Opcode>(immediate),
+                              Features{packed.extra}}};
+    case 2:
+      return Token{loc, type, static_cast<NumericType>(immediate)};
+    case 3:
+      return Token{loc, type, static_cast<ReferenceKind>(immediate)};
+    case 4:
+      return Token{loc, type, static_cast<HeapKind>(immediate)};
+    case 5:
+      return Token{loc, type, static_cast<PackedType>(immediate)};
+    case 6:
+      return Token{
+          loc, type,
+          LiteralInfo{static_cast<Sign>(immediate & 0xff),
+                      static_cast<LiteralKind>((immediate >> 8) & 0xff),
+                      static_cast<Base>((immediate >> 16) & 0xff),
+                      static_cast<HasUnderscores>(immediate >> 24)}};
+    case 7:
+      return Token{loc, type, Text{ToStringView(loc), immediate}};
+    case 8:
+      return Token{loc, type, static_cast<SimdShape>(immediate)};
+    default:
+      return Token{loc, type};
+  }
+}
+
+}  // namespace wasp::text
@@ -0,0 +1,79 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_TEXT_READ_TOKEN_BUFFER_H_
+#define WASP_TEXT_READ_TOKEN_BUFFER_H_
+
+#include <limits>
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/text/read/token.h"
+
+namespace wasp::text {
+
+// A token stored by offset into the source, with its immediate packed into a
+// few bytes. A Token is ~56 bytes; this is 16.
+struct PackedToken {
+  u32 offset;
+  u32 size;
+  u32 immediate;
+  u16 extra;
+  u8 type;
+  u8 immediate_index;  // Index of the Token::Immediate alternative.
+};
+
+// Lexes all of `data` up front, skipping whitespace and comments, into a
+// contiguous array of PackedTokens. The last token is always Eof.
+//
+// A Tokenizer constructed from a TokenBuffer reads from this array instead of
+// lexing on demand, so lexing can be profiled (or cached) separately from
+// parsing, and Peek has unlimited lookahead.
+//
+// Offsets are stored as u32, so `data` larger than kMaxSize is not buffered.
+// A Tokenizer constructed from such a TokenBuffer lexes on demand instead.
+class TokenBuffer {
+ public:
+  static constexpr size_t kMaxSize = std::numeric_limits<u32>::max();
+
+  explicit TokenBuffer(SpanU8 data);
+
+  auto data() const -> SpanU8;
+  auto size() const -> Index;
+  // False if `data` was too large to buffer. Get and Find must not be called
+  // in that case.
+  bool is_buffered() const;
+
+  // Returns the token at `index`, or the final Eof token if `index` is past
+  // the end.
+  auto Get(Index index) const -> Token;
+
+  // Returns the index of the first token that starts at or after `position`.
+  auto Find(const u8* position) const -> Index;
+
+ private:
+  static auto Pack(SpanU8 data, const Token&) -> PackedToken;
+
+  SpanU8 data_;
+  std::vector<PackedToken> tokens_;
+};
+
+}  // namespace wasp::text
+
+#include "wasp/text/read/token_buffer-inl.h"
+
+#endif  // WASP_TEXT_READ_TOKEN_BUFFER_H_
@@ -15,6 +15,7 @@
 //
 
 #include "wasp/text/read/lex.h"
+#include "wasp/text/read/token_buffer.h"
 
 #include <cassert>
 
@@ -22,11 +23,23 @@ namespace wasp::text {
 
 inline Tokenizer::Tokenizer(SpanU8 data) : data_{data} {}
 
+inline Tokenizer::Tokenizer(const TokenBuffer& buffer)
+    : data_{buffer.data()},
+      buffer_{buffer.is_buffered() ? &buffer : nullptr} {
+  // tokens_[0] caches the next token, since Peek(0) is by far the most common.
+  if (buffer_) {
+    tokens_[0] = buffer.Get(0);
+  }
+}
+
 inline bool Tokenizer::empty() const {
-  return count_ == 0;
+  return count() == 0;
 }
 
 inline auto Tokenizer::count() const -> int {
+  if (buffer_) {
+    return static_cast<int>(buffer_->size() - position_);
+  }
   return count_;
 }
 
@@ -35,6 +48,14 @@ inline auto Tokenizer::Previous() const -> Token {
 }
 
 inline auto Tokenizer::Read() -> Token {
+  if (buffer_) {
+    previous_token_ = tokens_[0];
+    // Stay on the final Eof token, like LexNoWhitespace does.
+    if (position_ + 1 < buffer_->size()) {
+      tokens_[0] = buffer_->Get(++position_);
+    }
+    return previous_token_;
+  }
   if (count_ == 0) {
     previous_token_ = LexNoWhitespace(&data_);
   } else {
@@ -46,6 +67,9 @@ inline auto Tokenizer::Read() -> Token {
 }
 
 inline auto Tokenizer::Peek(unsigned at) -> Token {
+  if (buffer_) {
+    return at == 0 ? tokens_[0] : buffer_->Get(position_ + at);
+  }
   if (count_ == 0) {
     tokens_[current_] = LexNoWhitespace(&data_);
     count_++;
@@ -77,4 +101,22 @@ inline auto Tokenizer::MatchLpar(TokenType token_type) -> optional<Token> {
   return Read();
 }
 
+inline auto Tokenizer::Remaining() -> SpanU8 {
+  // data_ always ends at the end of the input, in either mode.
+  return MakeSpan(Peek().loc.begin(), data_.end());
+}
+
+inline void Tokenizer::Seek(const u8* position, const Token& previous) {
+  assert(position >= Peek().loc.begin() && position <= data_.end());
+  previous_token_ = previous;
+  if (buffer_) {
+    position_ = buffer_->Find(position);
+    tokens_[0] = buffer_->Get(position_);
+  } else {
+    data_ = MakeSpan(position, data_.end());
+    current_ = 0;
+    count_ = 0;
+  }
+}
+
 }  // namespace wasp::text
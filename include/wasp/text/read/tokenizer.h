@@ -24,26 +24,42 @@
 
 namespace wasp::text {
 
+class TokenBuffer;
+
 class Tokenizer {
  public:
   explicit Tokenizer(SpanU8 data);
+  // Reads pre-lexed tokens from `buffer`, which must outlive the Tokenizer.
+  // In this mode, Peek can look arbitrarily far ahead. If `buffer` is not
+  // buffered (see TokenBuffer::is_buffered), this lexes on demand instead.
+  explicit Tokenizer(const TokenBuffer& buffer);
 
   bool empty() const;
   auto count() const -> int;
 
   auto Previous() const -> Token;
   auto Read() -> Token;
+  // Without a TokenBuffer, `at` must be 0 or 1.
   auto Peek(unsigned at = 0) -> Token;
 
   auto Match(TokenType) -> optional<Token>;
   auto MatchLpar(TokenType) -> optional<Token>;
 
+  // Returns the rest of the input, starting at the next token.
+  auto Remaining() -> SpanU8;
+  // Continues reading at `position`, which must be in Remaining() and not in
+  // the middle of a token, as if every token before it had been read and the
+  // last of them was `previous`.
+  void Seek(const u8* position, const Token& previous);
+
  private:
   SpanU8 data_;
   int current_ = 0;
   int count_ = 0;
   Token tokens_[2];  // Two tokens of lookahead.
   Token previous_token_;
+  const TokenBuffer* buffer_ = nullptr;
+  Index position_ = 0;  // Index of the next token in buffer_.
 };
 
 }  // namespace wasp::text
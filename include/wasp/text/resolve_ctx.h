@@ -20,6 +20,7 @@
 #include <map>
 #include <vector>
 
+#include "wasp/base/hashmap.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
@@ -47,6 +48,9 @@ using DefinedTypeList = std::vector<DefinedType>;
 // after all defined function types. It's as if they were added to the end of
 // the module, in the order they were used. That's the purpose of the
 // `deferred_list_` set below.
+//
+// Both lists are indexed by a hash of the type's params and results, ignoring
+// locations, so finding a type doesn't depend on the number of types.
 class FunctionTypeMap {
  public:
   using List = std::vector<optional<FunctionType>>;
@@ -63,13 +67,26 @@ class FunctionTypeMap {
   optional<FunctionType> Get(Index) const;
 
  private:
+  struct Hash {
+    size_t operator()(const FunctionType&) const;
+  };
+
+  struct Eq {
+    bool operator()(const FunctionType&, const FunctionType&) const;
+  };
+
+  // Maps each type to the index of its first occurrence in a list.
+  using IndexMap = flat_hash_map<FunctionType, Index, Hash, Eq>;
+
   static DefinedType ToDefinedType(const FunctionType&);
-  static List::const_iterator FindIter(const List&, const FunctionType&);
+  static optional<Index> Find(const IndexMap&, const FunctionType&);
   static bool IsSame(const FunctionType&, const FunctionType&);
   static bool IsSame(const ValueTypeList&, const ValueTypeList&);
 
   List list_;
   List deferred_list_;
+  IndexMap list_map_;
+  IndexMap deferred_map_;
 };
 
 struct ResolveCtx {
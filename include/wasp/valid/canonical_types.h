@@ -0,0 +1,71 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_CANONICAL_TYPES_H_
+#define WASP_VALID_CANONICAL_TYPES_H_
+
+#include <utility>
+#include <vector>
+
+#include "wasp/base/hashmap.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::valid {
+
+// Assigns each defined type a canonical ID, so that two types are equivalent
+// (see IsSame) if and only if they have the same ID. Types are compared
+// structurally, so two recursive types are equivalent if their unrollings
+// are.
+//
+// The IDs are found by partition refinement: the types are first grouped by
+// their shape, i.e. everything but the type indexes they reference. Then each
+// group is split until all the types in a group reference types from the same
+// groups.
+//
+// Since IsMatch is not symmetric it can't be reduced to an ID compare, but its
+// results are cached here too, keyed by canonical ID.
+class CanonicalTypes {
+ public:
+  void Reset();
+
+  // Compute the IDs for `types`. ValidCtx::types is only ever appended to, so
+  // this does nothing unless types were added since the last call.
+  void Update(const std::vector<binary::DefinedType>&);
+
+  bool IsValid(Index index) const { return index < ids_.size(); }
+  auto Get(Index index) const -> Index { return ids_[index]; }
+
+  // Cache for IsMatch, keyed by canonical ID. A pair that is currently being
+  // checked is assumed to match, to handle recursive types. Since a match that
+  // was found under an assumption may later turn out to be wrong, only
+  // mismatches and the results of outermost checks are cached.
+  auto GetMatch(Index expected, Index actual) const -> optional<bool>;
+  void AssumeMatch(Index expected, Index actual);
+  void ResolveMatch(Index expected, Index actual, bool is_match);
+
+ private:
+  using Pair = std::pair<Index, Index>;
+
+  std::vector<Index> ids_;
+  flat_hash_map<Pair, bool> match_;
+  flat_hash_set<Pair> assumed_match_;
+};
+
+}  // namespace wasp::valid
+
+#endif  // WASP_VALID_CANONICAL_TYPES_H_
@@ -0,0 +1,40 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_FUNCTION_STATS_H_
+#define WASP_VALID_FUNCTION_STATS_H_
+
+#include "wasp/base/types.h"
+
+namespace wasp::valid {
+
+// A summary of one function, gathered while it is validated. It gives what
+// is needed to size an interpreter frame, or to estimate a module's memory
+// use, without reading the function again.
+struct FunctionStats {
+  Index instruction_count = 0;
+  Index local_count = 0;       // Including params and let locals.
+  Index max_stack_height = 0;  // In values, including unreachable code.
+  Index max_label_depth = 0;   // Not counting the function body itself.
+  Index local_reads = 0;       // local.get
+  Index local_writes = 0;      // local.set and local.tee
+  Index calls = 0;             // All call and return_call instructions.
+  Index memory_accesses = 0;   // Instructions with a memarg immediate.
+};
+
+}  // namespace wasp::valid
+
+#endif  // WASP_VALID_FUNCTION_STATS_H_
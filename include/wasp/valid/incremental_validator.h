@@ -0,0 +1,99 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_INCREMENTAL_VALIDATOR_H_
+#define WASP_VALID_INCREMENTAL_VALIDATOR_H_
+
+#include <cstddef>
+#include <set>
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+#include "wasp/valid/valid_ctx.h"
+
+namespace wasp {
+
+class Errors;
+
+namespace valid {
+
+// Validates successive versions of the same module, e.g. in an edit/rebuild
+// loop, revalidating only what changed since the last valid version.
+//
+// After a module validates, the ValidCtx at the end of the declaration
+// sections (types, imports, functions, tables, memories, globals and events)
+// is kept, along with a hash of the bytes of every other section and of
+// every code entry. On the next call:
+//
+//   * If any declaration section changed, or the previous module was
+//     invalid, the whole module is validated again.
+//   * Otherwise, each of the export, start, element, data count and data
+//     sections is validated only if its bytes changed.
+//   * A code entry is validated only if its bytes changed, unless the set of
+//     declared functions, the element segment types or the data count
+//     changed, in which case all code entries are validated.
+//
+// The bytes of an item are those covered by its location, so the module
+// must have been read from the binary format.
+struct IncrementalValidator {
+  explicit IncrementalValidator(const Features&);
+
+  bool Validate(const binary::Module&, Errors&);
+
+  // Forgets the previous module, so the next call validates everything.
+  void Reset();
+
+  Features features;
+
+  // Describes the last call to Validate.
+  bool was_full_run = false;
+  Index validated_code_count = 0;
+
+ private:
+  struct Snapshot {
+    explicit Snapshot(ValidCtx declarations);
+
+    // Its errors pointer is not used; it is replaced when the context is
+    // copied for the next call.
+    ValidCtx declarations;
+    std::size_t declarations_hash = 0;
+    std::size_t exports_hash = 0;
+    std::size_t start_hash = 0;
+    std::size_t element_segments_hash = 0;
+    std::size_t data_count_hash = 0;
+    std::size_t data_segments_hash = 0;
+    std::vector<std::size_t> code_hashes;
+
+    // The state that the sections after the declarations add to the
+    // ValidCtx, so it can be restored when they are not validated again.
+    std::set<Index> export_declared_functions;
+    std::set<Index> element_declared_functions;
+    std::vector<binary::ReferenceType> element_segments;
+    optional<Index> declared_data_count;
+    // All declared functions, including those from global initializers.
+    std::set<Index> declared_functions;
+  };
+
+  optional<Snapshot> snapshot_;
+};
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_INCREMENTAL_VALIDATOR_H_
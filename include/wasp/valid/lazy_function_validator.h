@@ -0,0 +1,87 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_LAZY_FUNCTION_VALIDATOR_H_
+#define WASP_VALID_LAZY_FUNCTION_VALIDATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/code_index.h"
+#include "wasp/valid/valid_ctx.h"
+
+namespace wasp {
+
+class Errors;
+
+namespace valid {
+
+// Validates function bodies on demand, e.g. when a function is first called,
+// instead of validating the whole Code section up front.
+//
+// The ValidCtx must already have validated every other section of the module,
+// e.g. with a ValidateVisitor that has `skip_codes` set. It is copied, and
+// the copy is never changed, so ValidateFunction may be called from several
+// threads at once. Side tables and function stats are not recorded.
+//
+// The CodeIndex and the ValidCtx refer to the module's bytes, so the module
+// must outlive the validator.
+//
+// Each function is validated once, by the first call that asks for it. Its
+// errors are reported to the Errors passed to that call; other calls for the
+// same function wait for it to finish, then return the same result without
+// reporting anything. Errors are reported while holding a lock, so the
+// threads may share one Errors object.
+class LazyFunctionValidator {
+ public:
+  explicit LazyFunctionValidator(const ValidCtx&, binary::CodeIndex);
+
+  // Imported functions have no body, and are always valid. Returns false
+  // without reporting an error if the function index is out of range.
+  bool ValidateFunction(Index func_index, Errors&);
+
+  // Returns the result of validating the function, or nullopt if it has not
+  // been validated yet.
+  auto GetResult(Index func_index) const -> optional<bool>;
+
+  auto code_index() const -> const binary::CodeIndex&;
+
+ private:
+  enum : u8 { kNotValidated, kValid, kInvalid };
+
+  bool DoValidateFunction(Index func_index, Errors&);
+
+  ErrorsNop errors_nop_;
+  ValidCtx ctx_;
+  binary::CodeIndex code_index_;
+  std::vector<std::once_flag> once_flags_;
+  std::vector<std::atomic<u8>> results_;
+
+  // Copies of ctx_ that are not in use. Each call validates with its own
+  // copy, since validation changes the context.
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ValidCtx>> free_ctxs_;
+};
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_LAZY_FUNCTION_VALIDATOR_H_
@@ -22,19 +22,31 @@
 
 #include "wasp/base/optional.h"
 #include "wasp/binary/types.h"
+#include "wasp/valid/types.h"
 
 namespace wasp::valid {
 
+// The locals of a function, stored as runs of the same type.
+//
+// While there are at most `max_dense_count` locals, the types are also kept
+// in a flat table indexed by local, so GetStackType is a single load. Larger
+// functions (which may declare millions of locals) only use the runs.
+//
+// The types are stored as StackTypes, so GetType returns a type without
+// source locations.
 class LocalMap {
  public:
-  explicit LocalMap();
+  static constexpr Index kDefaultMaxDenseCount = 4096;
+
+  explicit LocalMap(Index max_dense_count = kDefaultMaxDenseCount);
 
   void Reset();
 
   auto GetCount() const -> Index;
   auto GetType(Index) const -> optional<binary::ValueType>;
-  bool Append(Index count, binary::ValueType);
-  bool Append(const binary::ValueTypeList&);
+  auto GetStackType(Index) const -> optional<StackType>;
+  bool Append(Index count, StackType);
+  bool Append(StackTypeSpan);
 
   // Push or pop a let-binding, which allocates new locals _before_ the current
   // set, e.g.
@@ -53,11 +65,13 @@ class LocalMap {
   void Pop();
 
  private:
-  using Pair = std::pair<binary::ValueType, Index>;
+  using Pair = std::pair<StackType, Index>;
   using Pairs = std::vector<Pair>;
 
   bool CanAppend(Index count) const;
+  bool IsDense() const;
   void AdjustPartialSums(Pairs::iterator first, Index count);
+  void RebuildDense();
 
   // Index is a partial sum, so the vector can be binary-searched, e.g.
   //
@@ -73,6 +87,10 @@ class LocalMap {
   // vector will never be empty; there is an implicit "let" block for the
   // function itself.
   std::vector<Index> let_stack_;
+
+  // One entry per local, but only while IsDense(); otherwise empty.
+  Index max_dense_count_;
+  StackTypeList dense_;
 };
 
 }  // namespace wasp::valid
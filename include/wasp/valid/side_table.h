@@ -0,0 +1,62 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_SIDE_TABLE_H_
+#define WASP_VALID_SIDE_TABLE_H_
+
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp::valid {
+
+// Where control goes when an instruction branches. Offsets are relative to
+// the location passed to BeginCode; for a binary::Code that is the start of
+// the code entry, including its size.
+struct SideTableEntry {
+  u32 offset;         // The branching instruction.
+  u32 target_offset;  // The instruction to continue at.
+  u32 value_count;    // Values at the top of the stack that are kept.
+  u32 drop_count;     // Values below those that are dropped.
+};
+
+// The branches of one function, recorded while it is validated, so an
+// interpreter or a CFG builder doesn't have to find the matching `end` by
+// re-reading the instructions. It is only meaningful if the function is valid.
+//
+// Entries are sorted by offset. These instructions have entries:
+//
+//   br, br_if, return   one, for the branch
+//   br_table            one per target, in order, then the default target
+//   if                  one, for the jump to the `else` (or `end`) when the
+//                       condition is false
+//   else, catch         one, for the jump to the `end` when falling through
+//                       the previous arm
+//
+// br_on_null, br_on_cast, br_on_exn, throw and rethrow have no entries.
+struct SideTable {
+  void Clear();
+
+  // Returns all entries for the instruction at `offset`, or an empty span.
+  auto Find(u32 offset) const -> span<const SideTableEntry>;
+
+  std::vector<SideTableEntry> entries;
+};
+
+}  // namespace wasp::valid
+
+#endif  // WASP_VALID_SIDE_TABLE_H_
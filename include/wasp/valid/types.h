@@ -17,8 +17,11 @@
 #ifndef WASP_VALID_TYPES_H_
 #define WASP_VALID_TYPES_H_
 
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "wasp/base/hashmap.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/span.h"
 #include "wasp/base/types.h"
@@ -28,9 +31,56 @@ namespace wasp::valid {
 
 struct Any {};
 
+// Storage for the rtts that are too deep for StackType's packed encoding. Each
+// ValidCtx has its own table, so it is freed with the module's ValidCtx, and
+// threads that each use their own copy of a ValidCtx don't need a lock.
+//
+// Copies of a table share the existing entries, so the StackTypes in a copied
+// ValidCtx stay valid even if the original is destroyed.
+class DeepRttTable {
+ public:
+  // Aligned so that the low bits of a pointer to it are free for the
+  // StackType's Kind and deep rtt bits.
+  struct alignas(16) Entry {
+    Index depth;
+    u64 heap_type_bits;  // The heap type, encoded as for a StackType.
+  };
+
+  // Returns the entry for the rtt, adding it if it isn't in the table yet.
+  auto Add(Index depth, u64 heap_type_bits) -> const Entry*;
+
+ private:
+  flat_hash_map<std::pair<Index, u64>, const Entry*> entries_by_rtt_;
+  std::vector<std::shared_ptr<const Entry>> entries_;
+};
+
+// A StackType is either a value type, or "any", the type of an operand that
+// was popped in unreachable code.
+//
+// The type is packed into a single 64-bit word so that type stacks can be
+// compared with memcmp, and copied without touching the heap. Locations are
+// not stored, so two StackTypes are equal if their types are equal.
+//
+//   bits 0..2   Kind
+//   bit 3       Nullable reference (Kind::Ref), or deep rtt (Kind::Rtt)
+//   bit 4       Heap type is a type index (Kind::Ref, Kind::Rtt)
+//   bits 5..31  Rtt depth (Kind::Rtt)
+//   bits 32..63 NumericType, ReferenceKind, HeapKind or type index
+//
+// Rtts deeper than kMaxRttDepth are rare, and are stored in a DeepRttTable
+// instead. For these "deep" rtts, the bits above bit 3 hold a pointer to the
+// table entry. Equal deep rtts from different tables have different bits, so
+// compare StackTypes with IsSame rather than by their bits.
 struct StackType {
+  enum class Kind : u8 { Any, Numeric, ReferenceKind, Ref, Rtt };
+
+  // The largest rtt depth that is stored in the packed encoding.
+  static constexpr Index kMaxRttDepth = (1u << 27) - 1;
+
   explicit StackType();
+  // `type` must not be an rtt deeper than kMaxRttDepth.
   explicit StackType(binary::ValueType);
+  explicit StackType(binary::ValueType, DeepRttTable&);
   explicit StackType(Any);
 
   static StackType I32();
@@ -45,13 +95,19 @@ struct StackType {
   static StackType I31ref();
   static StackType Exnref();
 
-  bool is_value_type() const;
-  bool is_any() const;
+  Kind kind() const { return Kind(bits & 7); }
+  bool is_value_type() const { return kind() != Kind::Any; }
+  bool is_any() const { return kind() == Kind::Any; }
+  bool is_numeric_type() const { return kind() == Kind::Numeric; }
+  bool is_reference_type() const {
+    return kind() == Kind::ReferenceKind || kind() == Kind::Ref;
+  }
+  bool is_rtt() const { return kind() == Kind::Rtt; }
 
-  auto value_type() -> binary::ValueType&;
-  auto value_type() const -> const binary::ValueType&;
+  // Decodes the value type. The result has no locations.
+  auto value_type() const -> binary::ValueType;
 
-  variant<binary::ValueType, Any> type;
+  u64 bits;
 };
 
 using StackTypeList = std::vector<StackType>;
@@ -62,13 +118,15 @@ auto ToValueType(binary::ReferenceType) -> binary::ValueType;
 auto ToValueType(binary::RefType) -> binary::ValueType;
 auto ToValueType(binary::HeapType) -> binary::ValueType;
 
-auto ToStackType(binary::StorageType) -> StackType;
-auto ToStackType(binary::ValueType) -> StackType;
+auto ToStackType(binary::StorageType, DeepRttTable&) -> StackType;
+auto ToStackType(binary::ValueType, DeepRttTable&) -> StackType;
 auto ToStackType(binary::ReferenceType) -> StackType;
 auto ToStackType(binary::RefType) -> StackType;
 auto ToStackType(binary::HeapType) -> StackType;
-auto ToStackTypeList(const binary::ValueTypeList&) -> StackTypeList;
-auto ToStackTypeList(const binary::LocalsList&) -> StackTypeList;
+auto ToStackTypeList(const binary::ValueTypeList&, DeepRttTable&)
+    -> StackTypeList;
+auto ToStackTypeList(const binary::LocalsList&, DeepRttTable&)
+    -> StackTypeList;
 
 bool IsReferenceTypeOrAny(StackType);
 bool IsRttOrAny(StackType);
@@ -89,7 +147,7 @@ auto AsNonNullableType(StackType) -> StackType;
 
 #define WASP_VALID_STRUCTS_CUSTOM_FORMAT(WASP_V) \
   WASP_V(valid::Any, 0)            \
-  WASP_V(valid::StackType, 1, type)
+  WASP_V(valid::StackType, 1, bits)
 
 #define WASP_VALID_CONTAINERS(WASP_V) \
   WASP_V(valid::StackTypeList)        \
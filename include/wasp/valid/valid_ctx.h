@@ -17,18 +17,21 @@
 #ifndef WASP_VALID_CONTEXT_H_
 #define WASP_VALID_CONTEXT_H_
 
-#include <map>
 #include <set>
 #include <vector>
 
 #include "wasp/base/errors.h"
 #include "wasp/base/features.h"
+#include "wasp/base/hashmap.h"
+#include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
 #include "wasp/binary/types.h"
-#include "wasp/valid/disjoint_set.h"
+#include "wasp/valid/canonical_types.h"
+#include "wasp/valid/function_stats.h"
 #include "wasp/valid/local_map.h"
+#include "wasp/valid/side_table.h"
 #include "wasp/valid/types.h"
 
 namespace wasp::valid {
@@ -44,36 +47,38 @@ enum class LabelType {
   Let,
 };
 
+// The params and results of a function or block type, as StackTypes.
+struct StackTypeSignature {
+  StackTypeList param_types;
+  StackTypeList result_types;
+};
+
+constexpr Index kNoSideTableEntry = ~Index{0};
+
+// A Label does not own its types; they are spans into a StackTypeSignature
+// that is interned in the ValidCtx (or in static storage).
 struct Label {
   Label(LabelType,
         StackTypeSpan param_types,
         StackTypeSpan result_types,
         Index type_stack_limit);
 
-  const StackTypeList& br_types() const {
+  StackTypeSpan br_types() const {
     return label_type == LabelType::Loop ? param_types : result_types;
   }
 
   LabelType label_type;
-  StackTypeList param_types;
-  StackTypeList result_types;
+  StackTypeSpan param_types;
+  StackTypeSpan result_types;
   Index type_stack_limit;
   bool unreachable;
-};
 
-class TypeRelationSet {
- public:
-  void Reset(Index);
-
-  auto Get(Index, Index) -> optional<bool>;
-  void Assume(Index, Index);
-  void Resolve(Index, Index, bool);
-
- private:
-  void MaybeSwapIndexes(Index&, Index&);
-
-  DisjointSet disjoint_set_;
-  std::map<std::pair<Index, Index>, bool> assume_;
+  // Used when building a SideTable. For a loop, this is the offset of its
+  // first instruction. Otherwise it is the head of a list of entries that
+  // branch to this label's `end`, linked through their target_offset.
+  u32 side_table_target;
+  // The entry for an `if`, until its `else` or `end` is found.
+  Index side_table_if;
 };
 
 struct ValidCtx {
@@ -88,6 +93,14 @@ struct ValidCtx {
   bool IsStructType(Index) const;
   bool IsArrayType(Index) const;
 
+  // Returns the signature of the function type at `index`, which must be a
+  // function type. Signatures are computed once and never change, so spans
+  // into them remain valid for the lifetime of this context.
+  auto GetFunctionSignature(Index) -> const StackTypeSignature&;
+  // Returns the signature of a block with no params and a single result,
+  // interned the same way.
+  auto GetBlockSignature(StackType result) -> const StackTypeSignature&;
+
   Features features;
   Errors* errors;
 
@@ -109,8 +122,20 @@ struct ValidCtx {
   std::set<string_view> export_names;
   std::set<Index> declared_functions;
 
-  TypeRelationSet same_types;
-  TypeRelationSet match_types;
+  CanonicalTypes canonical_types;
+  DeepRttTable deep_rtts;
+
+  // If set, BeginCode clears it, and the branches of the function are
+  // recorded in it. Offsets are relative to code_start.
+  SideTable* side_table = nullptr;
+  const u8* code_start = nullptr;
+
+  // If set, BeginCode clears it, and each instruction of the function is
+  // counted in it.
+  FunctionStats* function_stats = nullptr;
+
+  std::vector<optional<StackTypeSignature>> function_signatures;
+  flat_hash_map<StackType, StackTypeSignature> block_signatures;
 };
 
 }  // namespace wasp::valid
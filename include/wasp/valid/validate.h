@@ -20,6 +20,10 @@
 #include "wasp/base/types.h"
 #include "wasp/valid/types.h"
 
+namespace wasp::binary {
+struct ReadCtx;
+}  // namespace wasp::binary
+
 namespace wasp::valid {
 
 enum class RequireDefaultable {
@@ -32,6 +36,10 @@ struct ValidCtx;
 bool BeginTypeSection(ValidCtx&, Index type_count);
 bool BeginCode(ValidCtx&, Location loc);
 
+// Validate a function body, reading its instructions with the given ReadCtx.
+// As in visit::VisitCode, validation stops at the first failure.
+bool ValidateCode(ValidCtx&, const At<binary::Code>&, binary::ReadCtx&);
+
 bool CheckDefaultable(ValidCtx&,
                       const At<binary::ReferenceType>&,
                       string_view desc);
@@ -95,6 +103,8 @@ bool Validate(ValidCtx&,
 bool Validate(ValidCtx&, const binary::ValueTypeList&);
 bool Validate(ValidCtx&, const At<binary::UnpackedCode>&);
 bool Validate(ValidCtx&, const At<binary::UnpackedExpression>&);
+bool Validate(ValidCtx&, const At<binary::PackedCode>&);
+bool Validate(ValidCtx&, const binary::PackedExpression&);
 
 bool Validate(ValidCtx&, const binary::Module&);
 
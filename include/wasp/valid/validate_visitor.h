@@ -17,7 +17,11 @@
 #ifndef WASP_VALID_VALIDATE_VISITOR_H_
 #define WASP_VALID_VALIDATE_VISITOR_H_
 
+#include <vector>
+
 #include "wasp/binary/visitor.h"
+#include "wasp/valid/function_stats.h"
+#include "wasp/valid/side_table.h"
 #include "wasp/valid/valid_ctx.h"
 #include "wasp/valid/validate.h"
 
@@ -27,11 +31,28 @@ class Errors;
 
 namespace valid {
 
+// If `jobs` is greater than 1, the Code section is not visited. Instead,
+// OnSection reads the code headers, then reads and validates the function
+// bodies on `jobs` threads, each thread with its own copy of the module-level
+// ValidCtx. The errors are buffered per function and reported in function
+// order, stopping at the first function that fails, as with serial
+// validation. This requires that the visitor's BeginModule is called, as it
+// is by visit::Visit. When visited by a StreamDecoder, the Code section
+// hasn't fully arrived when it is visited, so it is validated serially.
+//
+// If `build_side_tables` is set, `side_tables[i]` holds the SideTable of the
+// i'th code entry. Likewise for `collect_function_stats` and
+// `function_stats`.
+//
+// If `skip_codes` is set, the Code section is not validated at all; see
+// LazyFunctionValidator to validate the function bodies later.
 struct ValidateVisitor : binary::visit::Visitor {
   using Result = binary::visit::Result;
 
-  explicit ValidateVisitor(Features features, Errors& errors);
+  explicit ValidateVisitor(Features features, Errors& errors, int jobs = 1);
 
+  auto BeginModule(binary::LazyModule&) -> Result;
+  auto OnSection(At<binary::Section>) -> Result;
   auto BeginTypeSection(binary::LazyTypeSection) -> Result;
   auto OnType(const At<binary::DefinedType>&) -> Result;
   auto OnImport(const At<binary::Import>&) -> Result;
@@ -43,15 +64,24 @@ struct ValidateVisitor : binary::visit::Visitor {
   auto OnStart(const At<binary::Start>&) -> Result;
   auto OnElement(const At<binary::ElementSegment>&) -> Result;
   auto OnDataCount(const At<binary::DataCount>&) -> Result;
+  auto BeginCodeSection(binary::LazyCodeSection) -> Result;
   auto BeginCode(const At<binary::Code>&) -> Result;
   auto OnInstruction(const At<binary::Instruction>&) -> Result;
   auto OnData(const At<binary::DataSegment>&) -> Result;
 
   auto FailUnless(bool) -> Result;
+  auto ValidateCodeSectionParallel(SpanU8) -> Result;
 
   ValidCtx ctx;
   Features features;
   Errors& errors;
+  int jobs;
+  binary::LazyModule* module = nullptr;
+  bool build_side_tables = false;
+  std::vector<SideTable> side_tables;
+  bool collect_function_stats = false;
+  std::vector<FunctionStats> function_stats;
+  bool skip_codes = false;
 };
 
 }  // namespace valid
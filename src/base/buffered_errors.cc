@@ -0,0 +1,58 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/buffered_errors.h"
+
+#include <algorithm>
+
+namespace wasp {
+
+void BufferedErrors::ReplayInto(Errors& errors,
+                                size_t begin,
+                                size_t end) const {
+  end = std::min(end, events_.size());
+  for (size_t i = begin; i < end; ++i) {
+    const auto& event = events_[i];
+    switch (event.kind) {
+      case EventKind::PushContext:
+        errors.PushContext(event.loc, event.text);
+        break;
+
+      case EventKind::PopContext:
+        errors.PopContext();
+        break;
+
+      case EventKind::Error:
+        errors.OnError(event.loc, event.text);
+        break;
+    }
+  }
+}
+
+void BufferedErrors::HandlePushContext(Location loc, string_view desc) {
+  events_.push_back(Event{EventKind::PushContext, loc, std::string{desc}});
+}
+
+void BufferedErrors::HandlePopContext() {
+  events_.push_back(Event{EventKind::PopContext, {}, {}});
+}
+
+void BufferedErrors::HandleOnError(Location loc, string_view message) {
+  events_.push_back(Event{EventKind::Error, loc, std::string{message}});
+  has_error_ = true;
+}
+
+}  // namespace wasp
@@ -17,7 +17,20 @@
 #include "wasp/base/file.h"
 
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "wasp/base/macros.h"
 
 namespace wasp {
 
@@ -39,4 +52,137 @@ optional<Buffer> ReadFile(string_view filename) {
   return buffer;
 }
 
+namespace {
+
+#if !defined(_WIN32)
+
+int ToMadvise(FileAccess access) {
+  switch (access) {
+    case FileAccess::Normal:     return MADV_NORMAL;
+    case FileAccess::Sequential: return MADV_SEQUENTIAL;
+    case FileAccess::Random:     return MADV_RANDOM;
+  }
+  WASP_UNREACHABLE();
+}
+
+bool ReadFd(int fd, Buffer& buffer) {
+  const size_t kChunkSize = 64 * 1024;
+  size_t size = 0;
+  for (;;) {
+    buffer.resize(size + kChunkSize);
+    ssize_t count = ::read(fd, buffer.data() + size, kChunkSize);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (count == 0) {
+      break;
+    }
+    size += count;
+  }
+  buffer.resize(size);
+  return true;
+}
+
+#endif
+
+}  // namespace
+
+MappedFile::MappedFile(MappedFile&& other) {
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Reset();
+    mapped_ = std::exchange(other.mapped_, false);
+    if (mapped_) {
+      span_ = std::exchange(other.span_, SpanU8{});
+    } else {
+      buffer_ = std::move(other.buffer_);
+      span_ = SpanU8{buffer_};
+      other.span_ = SpanU8{};
+    }
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Reset();
+}
+
+void MappedFile::Advise(FileAccess access) {
+#if !defined(_WIN32)
+  if (mapped_) {
+    ::madvise(const_cast<u8*>(span_.data()), span_.size(), ToMadvise(access));
+  }
+#endif
+}
+
+void MappedFile::Reset() {
+#if !defined(_WIN32)
+  if (mapped_) {
+    ::munmap(const_cast<u8*>(span_.data()), span_.size());
+  }
+#endif
+  span_ = SpanU8{};
+  mapped_ = false;
+  buffer_.clear();
+}
+
+optional<MappedFile> MapFile(string_view filename, FileAccess access) {
+  MappedFile file;
+
+#if defined(_WIN32)
+  if (filename == "-") {
+    file.buffer_.assign(std::istreambuf_iterator<char>{std::cin},
+                        std::istreambuf_iterator<char>{});
+  } else {
+    auto optbuf = ReadFile(filename);
+    if (!optbuf) {
+      return nullopt;
+    }
+    file.buffer_ = std::move(*optbuf);
+  }
+  file.span_ = SpanU8{file.buffer_};
+  return file;
+#else
+  bool is_stdin = filename == "-";
+  int fd = is_stdin ? STDIN_FILENO
+                    : ::open(std::string{filename}.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullopt;
+  }
+
+  struct stat st;
+  bool ok = ::fstat(fd, &st) == 0;
+  if (ok && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      file.span_ = SpanU8{static_cast<const u8*>(addr),
+                          static_cast<size_t>(st.st_size)};
+      file.mapped_ = true;
+      file.Advise(access);
+    }
+  }
+
+  if (ok && !file.mapped_) {
+    // Fall back to a buffered read for pipes, devices, empty files, or if the
+    // mapping failed.
+    ok = ReadFd(fd, file.buffer_);
+    file.span_ = SpanU8{file.buffer_};
+  }
+
+  if (!is_stdin) {
+    ::close(fd);
+  }
+  if (!ok) {
+    return nullopt;
+  }
+  return file;
+#endif
+}
+
 }  // namespace wasp
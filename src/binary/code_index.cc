@@ -0,0 +1,132 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/code_index.h"
+
+#include <limits>
+
+#include "wasp/base/concat.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/errors_context_guard.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/lazy_module_utils.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/var_int.h"
+
+namespace wasp::binary {
+
+CodeIndex::CodeIndex(SpanU8 section_data,
+                     ReadCtx& ctx,
+                     Index imported_function_count)
+    : data_{section_data}, imported_function_count_{imported_function_count} {
+  if (data_.size() >= std::numeric_limits<u32>::max()) {
+    ctx.errors.OnError(data_, "Code section is too large to index");
+    return;
+  }
+
+  ErrorsContextGuard guard{ctx.errors, data_, "code section"};
+  SpanU8 data = data_;
+  auto count = ReadCount(&data, ctx);
+  if (!count) {
+    return;
+  }
+
+  offsets_.reserve(*count + 1);
+  while (!data.empty()) {
+    const u8* begin = data.begin();
+    auto body_size = ReadLength(&data, ctx);
+    if (!body_size) {
+      // Keep the entries that were read successfully.
+      offsets_.push_back(static_cast<u32>(begin - data_.begin()));
+      return;
+    }
+    offsets_.push_back(static_cast<u32>(begin - data_.begin()));
+    data.remove_prefix(*body_size);
+  }
+  offsets_.push_back(static_cast<u32>(data_.size()));
+
+  if (size() != *count) {
+    ctx.errors.OnError(data_, concat("Expected code section to have count ",
+                                     *count, ", got ", size()));
+  }
+}
+
+Index CodeIndex::imported_function_count() const {
+  return imported_function_count_;
+}
+
+Index CodeIndex::size() const {
+  return offsets_.empty() ? 0 : static_cast<Index>(offsets_.size() - 1);
+}
+
+bool CodeIndex::empty() const {
+  return size() == 0;
+}
+
+bool CodeIndex::has_function(Index func_index) const {
+  return func_index >= imported_function_count_ &&
+         func_index - imported_function_count_ < size();
+}
+
+auto CodeIndex::GetLocation(Index func_index) const -> optional<Location> {
+  if (!has_function(func_index)) {
+    return nullopt;
+  }
+  Index index = func_index - imported_function_count_;
+  u32 begin = offsets_[index];
+  u32 end = offsets_[index + 1];
+  return data_.subspan(begin, end - begin);
+}
+
+auto CodeIndex::GetBody(Index func_index) const -> optional<SpanU8> {
+  auto loc = GetLocation(func_index);
+  if (!loc) {
+    return nullopt;
+  }
+  // The size prefix was already validated when building the index, so just
+  // skip over it.
+  SpanU8 body = *loc;
+  while (body[0] & VarInt<u32>::kExtendBit) {
+    body.remove_prefix(1);
+  }
+  body.remove_prefix(1);
+  return body;
+}
+
+auto CodeIndex::GetCode(Index func_index, ReadCtx& ctx) const -> OptAt<Code> {
+  auto loc = GetLocation(func_index);
+  if (!loc) {
+    return nullopt;
+  }
+  SpanU8 data = *loc;
+  return Read<Code>(&data, ctx);
+}
+
+auto ReadCodeIndex(LazyModule& module) -> CodeIndex {
+  for (auto section : module.sections) {
+    if (section->is_known()) {
+      auto known = section->known();
+      if (known->id == SectionId::Code) {
+        return CodeIndex{known->data, module.ctx,
+                         GetImportCount(module, ExternalKind::Function)};
+      }
+    }
+  }
+  return CodeIndex{};
+}
+
+}  // namespace wasp::binary
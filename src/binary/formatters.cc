@@ -458,6 +458,16 @@ std::ostream& operator<<(std::ostream& os,
   return os << self.instructions;
 }
 
+std::ostream& operator<<(std::ostream& os,
+                         const ::wasp::binary::PackedCode& self) {
+  return os << "{locals " << self.locals << ", body " << self.body << "}";
+}
+
+std::ostream& operator<<(std::ostream& os,
+                         const ::wasp::binary::PackedExpression& self) {
+  return os << self.ToInstructionList();
+}
+
 std::ostream& operator<<(std::ostream& os,
                          const ::wasp::binary::Module& self) {
   os << "{\n";
@@ -474,6 +484,7 @@ std::ostream& operator<<(std::ostream& os,
   os << "  data_count: " << self.data_count << "\n";
   os << "  codes: " << self.codes << "\n";
   os << "  data_segments: " << self.data_segments << "\n";
+  os << "  packed_codes: " << self.packed_codes << "\n";
   os << "}\n";
   return os;
 }
@@ -0,0 +1,281 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/instruction_scanner.h"
+
+#include <algorithm>
+
+#include "wasp/base/errors.h"
+#include "wasp/binary/read.h"
+
+namespace wasp::binary {
+
+namespace {
+
+bool SkipBytes(SpanU8* data, span_extent_t count) {
+  if (data->size() < count) {
+    return false;
+  }
+  data->remove_prefix(count);
+  return true;
+}
+
+// Skip a LEB128-encoded value. Values that use the maximum number of bytes
+// are read instead, since the unused bits of the last byte must be checked.
+template <typename T>
+bool SkipVarInt(SpanU8* data, ReadCtx& quiet_ctx) {
+  constexpr span_extent_t kMaxBytes = (sizeof(T) * 8 + 6) / 7;
+  span_extent_t size = std::min(data->size(), kMaxBytes - 1);
+  for (span_extent_t i = 0; i < size; ++i) {
+    if (((*data)[i] & 0x80) == 0) {
+      data->remove_prefix(i + 1);
+      return true;
+    }
+  }
+  return Read<T>(data, quiet_ctx).has_value();
+}
+
+bool SkipIndex(SpanU8* data, ReadCtx& quiet_ctx) {
+  return SkipVarInt<u32>(data, quiet_ctx);
+}
+
+bool SkipReserved(SpanU8* data) {
+  if (data->empty() || (*data)[0] != 0) {
+    return false;
+  }
+  data->remove_prefix(1);
+  return true;
+}
+
+bool SkipIndexOrReserved(SpanU8* data, ReadCtx& quiet_ctx, bool is_index) {
+  return is_index ? SkipIndex(data, quiet_ctx) : SkipReserved(data);
+}
+
+}  // namespace
+
+InstructionScanner::InstructionScanner(SpanU8 data, ReadCtx& ctx)
+    : ctx_{ctx},
+      quiet_ctx_{ctx.features, errors_nop_},
+      table_{ctx.opcode_table()},
+      data_start_{data.data()},
+      data_{data} {}
+
+bool InstructionScanner::Next() {
+  if (data_.empty()) {
+    return false;
+  }
+
+  const u8* start = data_.data();
+  if (seen_final_end_ || !ReadOpcode() || !SkipImmediate()) {
+    return OnError(start);
+  }
+
+  instruction_ = SpanU8{start, static_cast<span_extent_t>(immediate_.end() -
+                                                           start)};
+  return true;
+}
+
+bool InstructionScanner::ReadOpcode() {
+  u8 code = data_[0];
+  data_.remove_prefix(1);
+  OpcodeInfo info = table_.Lookup(code);
+  if (info.is_prefix()) {
+    const u8* ptr = data_.data();
+    if (!SkipIndex(&data_, quiet_ctx_)) {
+      return false;
+    }
+    info = table_.Lookup(code, DecodeU32(&ptr));
+  }
+  if (!info.is_valid()) {
+    return false;
+  }
+  opcode_ = info.opcode;
+  immediate_kind_ = info.immediate_kind;
+  return true;
+}
+
+bool InstructionScanner::SkipImmediate() {
+  SpanU8* data = &data_;
+  ReadCtx& quiet = quiet_ctx_;
+  const u8* start = data->data();
+  bool ok = true;
+
+  switch (immediate_kind_) {
+    case ImmediateKind::None:
+    case ImmediateKind::Else:
+    case ImmediateKind::Catch:
+      break;
+
+    case ImmediateKind::End:
+      if (block_depth_ == 0) {
+        seen_final_end_ = true;
+      } else {
+        block_depth_--;
+      }
+      break;
+
+    case ImmediateKind::HeapType:
+    case ImmediateKind::RttSub:
+      ok = Read<HeapType>(data, quiet).has_value();
+      break;
+
+    case ImmediateKind::Block:
+      ok = Read<BlockType>(data, quiet).has_value();
+      block_depth_++;
+      break;
+
+    case ImmediateKind::DataDrop:
+      ok = ctx_.declared_data_count.has_value() && SkipIndex(data, quiet);
+      break;
+
+    case ImmediateKind::Index:
+    case ImmediateKind::FuncBind:
+      ok = SkipIndex(data, quiet);
+      break;
+
+    case ImmediateKind::BrOnExn:
+    case ImmediateKind::StructField:
+      ok = SkipIndex(data, quiet) && SkipIndex(data, quiet);
+      break;
+
+    case ImmediateKind::BrTable: {
+      auto count = ReadCount(data, quiet);
+      ok = count.has_value();
+      for (Index i = 0; ok && i < **count; ++i) {
+        ok = SkipIndex(data, quiet);
+      }
+      ok = ok && SkipIndex(data, quiet);
+      break;
+    }
+
+    case ImmediateKind::CallIndirect:
+      ok = SkipIndex(data, quiet) &&
+           SkipIndexOrReserved(data, quiet,
+                               ctx_.features.reference_types_enabled());
+      break;
+
+    case ImmediateKind::MemArg:
+      ok = SkipVarInt<u32>(data, quiet) && SkipVarInt<u32>(data, quiet);
+      break;
+
+    case ImmediateKind::Reserved:
+      ok = SkipReserved(data);
+      break;
+
+    case ImmediateKind::I32Const:
+      ok = SkipVarInt<s32>(data, quiet);
+      break;
+
+    case ImmediateKind::I64Const:
+      ok = SkipVarInt<s64>(data, quiet);
+      break;
+
+    case ImmediateKind::F32Const:
+      ok = SkipBytes(data, sizeof(f32));
+      break;
+
+    case ImmediateKind::F64Const:
+      ok = SkipBytes(data, sizeof(f64));
+      break;
+
+    case ImmediateKind::V128Const:
+    case ImmediateKind::Shuffle:
+      ok = SkipBytes(data, 16);
+      break;
+
+    case ImmediateKind::MemoryInit:
+      ok = ctx_.declared_data_count.has_value() && SkipIndex(data, quiet) &&
+           SkipReserved(data);
+      break;
+
+    case ImmediateKind::TableInit:
+      ok = SkipIndex(data, quiet) &&
+           SkipIndexOrReserved(data, quiet,
+                               ctx_.features.reference_types_enabled());
+      break;
+
+    case ImmediateKind::MemoryCopy:
+      ok = SkipReserved(data) && SkipReserved(data);
+      break;
+
+    case ImmediateKind::TableCopy: {
+      bool is_index = ctx_.features.reference_types_enabled();
+      ok = SkipIndexOrReserved(data, quiet, is_index) &&
+           SkipIndexOrReserved(data, quiet, is_index);
+      break;
+    }
+
+    case ImmediateKind::SelectT: {
+      auto count = ReadCount(data, quiet);
+      ok = count.has_value();
+      for (Index i = 0; ok && i < **count; ++i) {
+        ok = Read<ValueType>(data, quiet).has_value();
+      }
+      break;
+    }
+
+    case ImmediateKind::Lane:
+      ok = SkipBytes(data, 1);
+      break;
+
+    case ImmediateKind::Let: {
+      quiet.local_count = 0;
+      ok = Read<BlockType>(data, quiet).has_value();
+      OptAt<Index> count;
+      if (ok) {
+        count = ReadCount(data, quiet);
+        ok = count.has_value();
+      }
+      for (Index i = 0; ok && i < **count; ++i) {
+        ok = Read<Locals>(data, quiet).has_value();
+      }
+      break;
+    }
+
+    case ImmediateKind::HeapType2:
+      ok = Read<HeapType2Immediate>(data, quiet).has_value();
+      break;
+
+    case ImmediateKind::BrOnCast:
+      ok = Read<BrOnCastImmediate>(data, quiet).has_value();
+      break;
+  }
+
+  immediate_ = SpanU8{start, static_cast<span_extent_t>(data->data() - start)};
+  return ok;
+}
+
+bool InstructionScanner::OnError(const u8* instruction_start) {
+  // Read the instruction again, so the error is reported exactly as
+  // ReadExpression would report it.
+  SpanU8 data{instruction_start,
+              static_cast<span_extent_t>(data_.end() - instruction_start)};
+  // Use a scratch ReadCtx that shares only the errors, so the caller's
+  // function state is left untouched.
+  ReadCtx scratch{ctx_.features, ctx_.errors};
+  scratch.declared_data_count = ctx_.declared_data_count;
+  scratch.local_count = ctx_.local_count;
+  scratch.seen_final_end = seen_final_end_;
+  auto instr = Read<Instruction>(&data, scratch);
+  if (instr.has_value()) {
+    // The scanner rejected an instruction that ReadExpression accepts.
+    ctx_.errors.OnError(instr->loc(), "Unable to skip instruction");
+  }
+  data_ = SpanU8{};
+  return false;
+}
+
+}  // namespace wasp::binary
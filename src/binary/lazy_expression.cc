@@ -20,6 +20,7 @@
 namespace wasp::binary {
 
 LazyExpression ReadExpression(SpanU8 data, ReadCtx& ctx) {
+  ctx.open_blocks.clear();
   ctx.seen_final_end = false;
   return LazyExpression{data, ctx};
 }
@@ -0,0 +1,244 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/module_stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+namespace {
+
+constexpr size_t kHeaderSize =
+    sizeof(encoding::Magic) + sizeof(encoding::Version);
+constexpr size_t kMaxU32Bytes = 5;
+
+enum class PeekResult { Ok, NeedMore, Malformed };
+
+// Peek at a LEB128-encoded u32 without reporting errors. Malformed values are
+// left for the regular reader to diagnose.
+PeekResult PeekU32(SpanU8 data, u32* value, size_t* length) {
+  u32 result = 0;
+  for (size_t i = 0; i < kMaxU32Bytes; ++i) {
+    if (i >= data.size()) {
+      return PeekResult::NeedMore;
+    }
+    u8 byte = data[i];
+    result |= u32(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      *length = i + 1;
+      return PeekResult::Ok;
+    }
+  }
+  return PeekResult::Malformed;
+}
+
+}  // namespace
+
+ModuleStream::ModuleStream(size_t max_section_size)
+    : max_section_size_{max_section_size} {}
+
+void ModuleStream::Append(SpanU8 data) {
+  assert(input_.empty());
+  assert(!finished_);
+  input_ = data;
+}
+
+void ModuleStream::Finish() {
+  finished_ = true;
+}
+
+auto ModuleStream::Next() -> optional<Item> {
+  switch (state_) {
+    case State::Header: {
+      TakeInput(std::min(kHeaderSize - pending_.size(), input_.size()));
+      if (pending_.size() < kHeaderSize && !(finished_ && input_.empty())) {
+        return nullopt;
+      }
+      state_ = State::SectionHeader;
+      return Item{ItemKind::Header, TakePending()};
+    }
+
+    case State::SectionHeader: {
+      // Read the section id, then one byte at a time until the length is
+      // known.
+      u32 length;
+      size_t length_size;
+      auto peek = PeekResult::NeedMore;
+      while (!input_.empty()) {
+        TakeInput(1);
+        if (pending_.size() > 1) {
+          peek = PeekU32(SpanU8{pending_}.subspan(1), &length, &length_size);
+          if (peek != PeekResult::NeedMore) {
+            break;
+          }
+        }
+      }
+
+      if (peek == PeekResult::NeedMore) {
+        if (!finished_) {
+          return nullopt;
+        }
+        state_ = State::Done;
+        if (pending_.empty()) {
+          return nullopt;
+        }
+        // Truncated section header.
+        return Item{ItemKind::Section, TakePending()};
+      } else if (peek == PeekResult::Malformed) {
+        // Let the reader report an error for the malformed length.
+        state_ = State::Done;
+        return Item{ItemKind::Section, TakePending()};
+      } else if (length > max_section_size_) {
+        // Don't allocate storage for a section that is too large.
+        state_ = State::Done;
+        return Item{ItemKind::SectionTooLarge, TakePending()};
+      }
+
+      is_code_ = pending_[0] == encoding::SectionId::Encode(SectionId::Code);
+      code_begun_ = false;
+      code_pos_ = pending_.size();
+      unit_size_ = pending_.size() + length;
+      unit_filled_ = pending_.size();
+      unit_ = Allocate(unit_size_);
+      memcpy(unit_, pending_.data(), pending_.size());
+      pending_.clear();
+      state_ = State::SectionBody;
+      return Next();
+    }
+
+    case State::SectionBody: {
+      size_t count = std::min(unit_size_ - unit_filled_, input_.size());
+      memcpy(unit_ + unit_filled_, input_.data(), count);
+      input_.remove_prefix(count);
+      unit_filled_ += count;
+
+      if (is_code_) {
+        return NextCode();
+      }
+
+      if (unit_filled_ == unit_size_) {
+        state_ = State::SectionHeader;
+        return Item{ItemKind::Section, unit()};
+      } else if (finished_) {
+        state_ = State::Done;
+        return Item{ItemKind::Section, filled()};
+      }
+      return nullopt;
+    }
+
+    case State::Done:
+      return nullopt;
+  }
+  WASP_UNREACHABLE();
+}
+
+auto ModuleStream::NextCode() -> optional<Item> {
+  bool complete = unit_filled_ == unit_size_;
+  u32 length;
+  size_t length_size;
+  auto peek = PeekU32(filled().subspan(code_pos_), &length, &length_size);
+
+  if (!code_begun_) {
+    // Wait for the code count.
+    if (peek != PeekResult::NeedMore || complete) {
+      code_begun_ = true;
+      code_pos_ += peek == PeekResult::Ok ? length_size : 0;
+      return Item{ItemKind::CodeSectionBegin, unit()};
+    }
+  } else if (code_pos_ == unit_size_) {
+    state_ = State::SectionHeader;
+    return Item{ItemKind::CodeSectionEnd, unit()};
+  } else if (peek == PeekResult::Ok &&
+             code_pos_ + length_size + length <= unit_size_) {
+    size_t body_end = code_pos_ + length_size + length;
+    if (body_end <= unit_filled_) {
+      SpanU8 body = unit().subspan(code_pos_, body_end - code_pos_);
+      code_pos_ = body_end;
+      return Item{ItemKind::Code, body};
+    }
+  } else if (complete) {
+    // The body is malformed or extends past the end of the section. Produce
+    // the rest of the section so the reader can report the error.
+    SpanU8 body = unit().subspan(code_pos_);
+    code_pos_ = unit_size_;
+    return Item{ItemKind::Code, body};
+  }
+
+  if (finished_) {
+    state_ = State::Done;
+    return Item{code_begun_ ? ItemKind::Code : ItemKind::Section,
+                filled().subspan(code_begun_ ? code_pos_ : 0)};
+  }
+  return nullopt;
+}
+
+auto ModuleStream::bytes_needed() const -> size_t {
+  switch (state_) {
+    case State::Header:
+      return kHeaderSize - pending_.size();
+
+    case State::SectionHeader:
+      return 1;
+
+    case State::SectionBody:
+      if (is_code_ && code_begun_) {
+        u32 length;
+        size_t length_size;
+        auto peek = PeekU32(filled().subspan(code_pos_), &length, &length_size);
+        if (peek == PeekResult::Ok) {
+          size_t body_end =
+              std::min(code_pos_ + length_size + length, unit_size_);
+          return std::max<size_t>(body_end - unit_filled_, 1);
+        }
+        return 1;
+      } else if (is_code_) {
+        return 1;
+      }
+      return unit_size_ - unit_filled_;
+
+    case State::Done:
+      return 0;
+  }
+  WASP_UNREACHABLE();
+}
+
+void ModuleStream::TakeInput(size_t count) {
+  pending_.insert(pending_.end(), input_.begin(), input_.begin() + count);
+  input_.remove_prefix(count);
+}
+
+auto ModuleStream::TakePending() -> SpanU8 {
+  u8* data = Allocate(pending_.size());
+  memcpy(data, pending_.data(), pending_.size());
+  SpanU8 result{data, pending_.size()};
+  pending_.clear();
+  return result;
+}
+
+auto ModuleStream::Allocate(size_t size) -> u8* {
+  storage_.emplace_back(new u8[std::max<size_t>(size, 1)]);
+  return storage_.back().get();
+}
+
+}  // namespace wasp::binary
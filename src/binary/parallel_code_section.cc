@@ -0,0 +1,35 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/parallel_code_section.h"
+
+#include "wasp/binary/sections.h"
+
+namespace wasp::binary {
+
+ParallelCodeSection::ParallelCodeSection(SpanU8 section_data, ReadCtx& ctx)
+    : ctx_{ctx}, section_errors_{ctx.errors.has_context()} {
+  ReadCtx section_ctx{ctx.features, section_errors_};
+  section_ctx.code_count = ctx.code_count;
+  for (const auto& code : ReadCodeSection(section_data, section_ctx).sequence) {
+    codes_.push_back(code);
+    local_counts_.push_back(section_ctx.local_count);
+    marks_.push_back(section_errors_.size());
+  }
+  ctx.code_count = section_ctx.code_count;
+}
+
+}  // namespace wasp::binary
@@ -18,8 +18,11 @@
 
 #include "wasp/base/errors_context_guard.h"
 #include "wasp/binary/lazy_module.h"
+#include "wasp/binary/parallel_code_section.h"
 #include "wasp/binary/read/location_guard.h"
 #include "wasp/binary/read/macros.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/sections.h"
 #include "wasp/binary/visitor.h"
 
 namespace wasp::binary {
@@ -27,7 +30,8 @@ namespace wasp::binary {
 using visit::Result;
 
 struct EagerModuleVisitor : visit::Visitor {
-  explicit EagerModuleVisitor(Module& module) : module{module} {}
+  explicit EagerModuleVisitor(Module& module, SpanU8 data, CodeFormat format)
+      : module{module}, data{data}, format{format} {}
 
   auto OnType(const At<DefinedType>& type) -> Result {
     module.types.push_back(type);
@@ -85,12 +89,12 @@ struct EagerModuleVisitor : visit::Visitor {
   }
 
   auto BeginCode(const At<Code>& code) -> Result {
-    module.codes.push_back(At{code.loc(), UnpackedCode{code->locals, {}}});
+    AddCode(code);
     return Result::Ok;
   }
 
   auto OnInstruction(const At<Instruction>& instruction) -> Result {
-    module.codes.back()->body.instructions.push_back(instruction);
+    AddInstruction(code_count() - 1, instruction);
     return Result::Ok;
   }
 
@@ -99,10 +103,75 @@ struct EagerModuleVisitor : visit::Visitor {
     return Result::Ok;
   }
 
+  Index code_count() const {
+    return static_cast<Index>(format == CodeFormat::Packed
+                                  ? module.packed_codes.size()
+                                  : module.codes.size());
+  }
+
+  void AddCode(const At<Code>& code) {
+    if (format == CodeFormat::Packed) {
+      module.packed_codes.push_back(
+          At{code.loc(), PackedCode{code->locals, PackedExpression{data}}});
+    } else {
+      module.codes.push_back(At{code.loc(), UnpackedCode{code->locals, {}}});
+    }
+  }
+
+  // Each code body is only modified by one thread at a time, so this can be
+  // called concurrently for different `code_index`es.
+  void AddInstruction(Index code_index, const At<Instruction>& instruction) {
+    if (format == CodeFormat::Packed) {
+      module.packed_codes[code_index]->body.push_back(instruction);
+    } else {
+      module.codes[code_index]->body.instructions.push_back(instruction);
+    }
+  }
+
   Module& module;
+  SpanU8 data;
+  CodeFormat format;
 };
 
-auto ReadModule(SpanU8 data, ReadCtx& ctx) -> optional<Module> {
+// Reads the Code section, decoding the function bodies on `jobs` threads.
+void ReadCodeSectionParallel(LazyModule& module,
+                             SpanU8 section_data,
+                             EagerModuleVisitor& visitor,
+                             int jobs) {
+  ParallelCodeSection section{section_data, module.ctx};
+  const Index first_code_index = visitor.code_count();
+  for (const auto& code : section.codes()) {
+    visitor.AddCode(code);
+  }
+
+  section.ForEach(jobs, [&](Index index, Index, const At<Code>& code,
+                            ReadCtx& read_ctx) {
+    for (auto&& instr : ReadExpression(*code->body, read_ctx)) {
+      visitor.AddInstruction(first_code_index + index, instr);
+    }
+    EndCode(code->body->data.last(0), read_ctx);
+    return true;
+  });
+}
+
+// The same as visit::Visit, but the Code section is read with
+// ReadCodeSectionParallel.
+auto VisitParallel(LazyModule& module, EagerModuleVisitor& visitor, int jobs)
+    -> Result {
+  module.ctx.Reset();
+  for (auto section : module.sections) {
+    if (section->is_known() && section->known()->id == SectionId::Code) {
+      ReadCodeSectionParallel(module, section->known()->data, visitor, jobs);
+    } else if (visit::VisitSection(module, section, visitor) == Result::Fail) {
+      return Result::Fail;
+    }
+  }
+  EndModule(module.data, module.ctx);
+  return Result::Ok;
+}
+
+auto ReadModule(SpanU8 data, ReadCtx& ctx, CodeFormat format, int jobs)
+    -> optional<Module> {
   ErrorsContextGuard error_guard{ctx.errors, data, "module"};
   LazyModule lazy_module{data, ctx.features, ctx.errors};
   if (!(lazy_module.magic.has_value() && lazy_module.version.has_value())) {
@@ -110,8 +179,10 @@ auto ReadModule(SpanU8 data, ReadCtx& ctx) -> optional<Module> {
   }
 
   Module module;
-  EagerModuleVisitor visitor{module};
-  if (Visit(lazy_module, visitor) == Result::Fail || ctx.errors.HasError()) {
+  EagerModuleVisitor visitor{module, data, format};
+  auto result = jobs > 1 ? VisitParallel(lazy_module, visitor, jobs)
+                         : Visit(lazy_module, visitor);
+  if (result == Result::Fail || ctx.errors.HasError()) {
     return nullopt;
   }
   return module;
@@ -16,6 +16,10 @@
 
 #include "wasp/binary/types.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "wasp/base/bitcast.h"
 #include "wasp/base/hash.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/operator_eq_ne_macros.h"
@@ -914,6 +918,531 @@ SpanU8 Section::data() const {
   return is_known() ? known()->data : custom()->data;
 }
 
+namespace {
+
+// Immediates that don't fit in 64 bits are stored in PackedExpression's side
+// buffer as a sequence of u32 words.
+class ExtraWriter {
+ public:
+  explicit ExtraWriter(std::vector<u32>& out) : out_{out} {}
+
+  void Write(u32 value) { out_.push_back(value); }
+
+  template <typename T, size_t N>
+  void Write(const std::array<T, N>& value) {
+    static_assert(sizeof(value) % sizeof(u32) == 0);
+    u32 words[sizeof(value) / sizeof(u32)];
+    memcpy(words, value.data(), sizeof(value));
+    for (u32 word : words) {
+      Write(word);
+    }
+  }
+
+  void Write(const HeapType& value) {
+    if (value.is_heap_kind()) {
+      Write(0);
+      Write(static_cast<u32>(*value.heap_kind()));
+    } else {
+      Write(1);
+      Write(*value.index());
+    }
+  }
+
+  void Write(const ValueType& value) {
+    if (value.is_numeric_type()) {
+      Write(0);
+      Write(static_cast<u32>(*value.numeric_type()));
+    } else if (value.is_reference_type()) {
+      const auto& reference_type = *value.reference_type();
+      if (reference_type.is_reference_kind()) {
+        Write(1);
+        Write(static_cast<u32>(*reference_type.reference_kind()));
+      } else {
+        Write(2);
+        Write(static_cast<u32>(reference_type.ref()->null));
+        Write(*reference_type.ref()->heap_type);
+      }
+    } else {
+      Write(3);
+      Write(*value.rtt()->depth);
+      Write(*value.rtt()->type);
+    }
+  }
+
+  void Write(const BlockType& value) {
+    if (value.is_void()) {
+      Write(0);
+    } else if (value.is_index()) {
+      Write(1);
+      Write(*value.index());
+    } else {
+      Write(2);
+      Write(*value.value_type());
+    }
+  }
+
+  void Write(const HeapType2Immediate& value) {
+    Write(*value.parent);
+    Write(*value.child);
+  }
+
+  void Write(const ValueTypeList& value) {
+    Write(static_cast<u32>(value.size()));
+    for (const auto& value_type : value) {
+      Write(*value_type);
+    }
+  }
+
+  void Write(const LocalsList& value) {
+    Write(static_cast<u32>(value.size()));
+    for (const auto& locals : value) {
+      Write(*locals->count);
+      Write(*locals->type);
+    }
+  }
+
+ private:
+  std::vector<u32>& out_;
+};
+
+// Reads values written by ExtraWriter. Every value is given the same location,
+// the location of the immediate.
+class ExtraReader {
+ public:
+  explicit ExtraReader(const std::vector<u32>& in, u64 offset, Location loc)
+      : in_{in}, pos_{static_cast<size_t>(offset)}, loc_{loc} {}
+
+  u32 ReadU32() { return in_[pos_++]; }
+
+  template <typename T>
+  T ReadArray() {
+    T result;
+    static_assert(sizeof(result) % sizeof(u32) == 0);
+    memcpy(result.data(), &in_[pos_], sizeof(result));
+    pos_ += sizeof(result) / sizeof(u32);
+    return result;
+  }
+
+  template <typename T>
+  At<T> ReadEnum() {
+    return At{loc_, static_cast<T>(ReadU32())};
+  }
+
+  At<Index> ReadIndex() { return At{loc_, ReadU32()}; }
+
+  At<HeapType> ReadHeapType() {
+    if (ReadU32() == 0) {
+      return At{loc_, HeapType{ReadEnum<HeapKind>()}};
+    }
+    return At{loc_, HeapType{ReadIndex()}};
+  }
+
+  At<ValueType> ReadValueType() {
+    switch (ReadU32()) {
+      case 0:
+        return At{loc_, ValueType{ReadEnum<NumericType>()}};
+
+      case 1:
+        return At{loc_, ValueType{At{loc_, ReferenceType{
+                                              ReadEnum<ReferenceKind>()}}}};
+
+      case 2: {
+        auto null = static_cast<Null>(ReadU32());
+        auto heap_type = ReadHeapType();
+        return At{loc_, ValueType{At{loc_, ReferenceType{At{
+                                              loc_, RefType{heap_type, null}}}}}};
+      }
+
+      default: {
+        auto depth = ReadIndex();
+        auto type = ReadHeapType();
+        return At{loc_, ValueType{At{loc_, Rtt{depth, type}}}};
+      }
+    }
+  }
+
+  At<BlockType> ReadBlockType() {
+    switch (ReadU32()) {
+      case 0:
+        return At{loc_, BlockType{At{loc_, VoidType{}}}};
+      case 1:
+        return At{loc_, BlockType{ReadIndex()}};
+      default:
+        return At{loc_, BlockType{ReadValueType()}};
+    }
+  }
+
+  HeapType2Immediate ReadHeapType2() {
+    auto parent = ReadHeapType();
+    auto child = ReadHeapType();
+    return HeapType2Immediate{parent, child};
+  }
+
+  ValueTypeList ReadValueTypeList() {
+    ValueTypeList result;
+    u32 count = ReadU32();
+    result.reserve(count);
+    for (u32 i = 0; i < count; ++i) {
+      result.push_back(ReadValueType());
+    }
+    return result;
+  }
+
+  LocalsList ReadLocalsList() {
+    LocalsList result;
+    u32 count = ReadU32();
+    result.reserve(count);
+    for (u32 i = 0; i < count; ++i) {
+      auto locals_count = ReadIndex();
+      auto type = ReadValueType();
+      result.push_back(At{loc_, Locals{locals_count, type}});
+    }
+    return result;
+  }
+
+ private:
+  const std::vector<u32>& in_;
+  size_t pos_;
+  Location loc_;
+};
+
+u64 PackPair(u32 first, u32 second) {
+  return u64{first} | (u64{second} << 32);
+}
+
+u32 First(u64 value) {
+  return static_cast<u32>(value);
+}
+
+u32 Second(u64 value) {
+  return static_cast<u32>(value >> 32);
+}
+
+}  // namespace
+
+PackedExpression::PackedExpression(SpanU8 base) : base_{base} {}
+
+PackedExpression::PackedExpression(SpanU8 base,
+                                   const InstructionList& instructions)
+    : base_{base} {
+  reserve(static_cast<Index>(instructions.size()));
+  for (const auto& instruction : instructions) {
+    push_back(instruction);
+  }
+}
+
+SpanU8 PackedExpression::base() const {
+  return base_;
+}
+
+Index PackedExpression::size() const {
+  return static_cast<Index>(opcodes_.size());
+}
+
+bool PackedExpression::empty() const {
+  return opcodes_.empty();
+}
+
+void PackedExpression::reserve(Index count) {
+  opcodes_.reserve(count);
+  kinds_.reserve(count);
+  opcode_sizes_.reserve(count);
+  locs_.reserve(count);
+  immediates_.reserve(count);
+}
+
+void PackedExpression::push_back(const At<Instruction>& value) {
+  const Instruction& instr = *value;
+  u64 immediate = 0;
+  ExtraWriter extra{extra_};
+  auto extra_offset = [&]() { return static_cast<u64>(extra_.size()); };
+
+  switch (instr.kind()) {
+    case InstructionKind::None:
+      break;
+
+    case InstructionKind::S32:
+      immediate = static_cast<u32>(*instr.s32_immediate());
+      break;
+
+    case InstructionKind::S64:
+      immediate = static_cast<u64>(*instr.s64_immediate());
+      break;
+
+    case InstructionKind::F32:
+      immediate = Bitcast<u32>(*instr.f32_immediate());
+      break;
+
+    case InstructionKind::F64:
+      immediate = Bitcast<u64>(*instr.f64_immediate());
+      break;
+
+    case InstructionKind::V128:
+      immediate = extra_offset();
+      extra.Write(instr.v128_immediate()->as<u32x4>());
+      break;
+
+    case InstructionKind::Index:
+      immediate = *instr.index_immediate();
+      break;
+
+    case InstructionKind::BlockType:
+      immediate = extra_offset();
+      extra.Write(*instr.block_type_immediate());
+      break;
+
+    case InstructionKind::BrOnExn: {
+      const auto& imm = *instr.br_on_exn_immediate();
+      immediate = PackPair(imm.target, imm.event_index);
+      break;
+    }
+
+    case InstructionKind::BrTable: {
+      const auto& imm = *instr.br_table_immediate();
+      immediate = extra_offset();
+      extra.Write(static_cast<u32>(imm.targets.size()));
+      for (const auto& target : imm.targets) {
+        extra.Write(*target);
+      }
+      extra.Write(*imm.default_target);
+      break;
+    }
+
+    case InstructionKind::CallIndirect: {
+      const auto& imm = *instr.call_indirect_immediate();
+      immediate = PackPair(imm.index, imm.table_index);
+      break;
+    }
+
+    case InstructionKind::Copy: {
+      const auto& imm = *instr.copy_immediate();
+      immediate = PackPair(imm.dst_index, imm.src_index);
+      break;
+    }
+
+    case InstructionKind::Init: {
+      const auto& imm = *instr.init_immediate();
+      immediate = PackPair(imm.segment_index, imm.dst_index);
+      break;
+    }
+
+    case InstructionKind::Let: {
+      const auto& imm = *instr.let_immediate();
+      immediate = extra_offset();
+      extra.Write(*imm.block_type);
+      extra.Write(imm.locals);
+      break;
+    }
+
+    case InstructionKind::MemArg: {
+      const auto& imm = *instr.mem_arg_immediate();
+      immediate = PackPair(imm.align_log2, imm.offset);
+      break;
+    }
+
+    case InstructionKind::HeapType:
+      immediate = extra_offset();
+      extra.Write(*instr.heap_type_immediate());
+      break;
+
+    case InstructionKind::Select:
+      immediate = extra_offset();
+      extra.Write(*instr.select_immediate());
+      break;
+
+    case InstructionKind::Shuffle:
+      immediate = extra_offset();
+      extra.Write(*instr.shuffle_immediate());
+      break;
+
+    case InstructionKind::SimdLane:
+      immediate = *instr.simd_lane_immediate();
+      break;
+
+    case InstructionKind::FuncBind:
+      immediate = instr.func_bind_immediate()->index;
+      break;
+
+    case InstructionKind::BrOnCast: {
+      const auto& imm = *instr.br_on_cast_immediate();
+      immediate = extra_offset();
+      extra.Write(*imm.target);
+      extra.Write(imm.types);
+      break;
+    }
+
+    case InstructionKind::HeapType2:
+      immediate = extra_offset();
+      extra.Write(*instr.heap_type_2_immediate());
+      break;
+
+    case InstructionKind::RttSub: {
+      const auto& imm = *instr.rtt_sub_immediate();
+      immediate = extra_offset();
+      extra.Write(*imm.depth);
+      extra.Write(imm.types);
+      break;
+    }
+
+    case InstructionKind::StructField: {
+      const auto& imm = *instr.struct_field_immediate();
+      immediate = PackPair(imm.struct_, imm.field);
+      break;
+    }
+  }
+
+  CompactLocation loc{base_, value.loc()};
+  Location opcode_loc = instr.opcode.loc();
+  u8 opcode_size = 0;
+  if (loc.is_valid() && opcode_loc.begin() == value.loc().begin() &&
+      opcode_loc.size() <= value.loc().size()) {
+    opcode_size = static_cast<u8>(opcode_loc.size());
+  }
+
+  opcodes_.push_back(instr.opcode);
+  kinds_.push_back(instr.kind());
+  opcode_sizes_.push_back(opcode_size);
+  locs_.push_back(loc);
+  immediates_.push_back(immediate);
+}
+
+auto PackedExpression::opcode(Index index) const -> Opcode {
+  return opcodes_[index];
+}
+
+auto PackedExpression::kind(Index index) const -> InstructionKind {
+  return kinds_[index];
+}
+
+auto PackedExpression::loc(Index index) const -> Location {
+  return locs_[index].ToLocation(base_);
+}
+
+auto PackedExpression::operator[](Index index) const -> At<Instruction> {
+  Location loc = this->loc(index);
+  size_t opcode_size = std::min<size_t>(opcode_sizes_[index], loc.size());
+  At<Opcode> opcode{loc.first(opcode_size), opcodes_[index]};
+  Location imm_loc = loc.subspan(opcode_size);
+  u64 immediate = immediates_[index];
+  ExtraReader extra{extra_, immediate, imm_loc};
+
+  auto make = [&](auto&& value) {
+    return At{loc, Instruction{opcode, At{imm_loc, value}}};
+  };
+
+  switch (kinds_[index]) {
+    case InstructionKind::None:
+      return At{loc, Instruction{opcode}};
+
+    case InstructionKind::S32:
+      return make(static_cast<s32>(First(immediate)));
+
+    case InstructionKind::S64:
+      return make(static_cast<s64>(immediate));
+
+    case InstructionKind::F32:
+      return make(Bitcast<f32>(First(immediate)));
+
+    case InstructionKind::F64:
+      return make(Bitcast<f64>(immediate));
+
+    case InstructionKind::V128:
+      return make(v128{extra.ReadArray<u32x4>()});
+
+    case InstructionKind::Index:
+      return make(Index{First(immediate)});
+
+    case InstructionKind::BlockType:
+      return make(*extra.ReadBlockType());
+
+    case InstructionKind::BrOnExn:
+      return make(BrOnExnImmediate{At{imm_loc, First(immediate)},
+                                   At{imm_loc, Second(immediate)}});
+
+    case InstructionKind::BrTable: {
+      IndexList targets(extra.ReadU32());
+      for (auto& target : targets) {
+        target = extra.ReadIndex();
+      }
+      auto default_target = extra.ReadIndex();
+      return make(BrTableImmediate{std::move(targets), default_target});
+    }
+
+    case InstructionKind::CallIndirect:
+      return make(CallIndirectImmediate{At{imm_loc, First(immediate)},
+                                        At{imm_loc, Second(immediate)}});
+
+    case InstructionKind::Copy:
+      return make(CopyImmediate{At{imm_loc, First(immediate)},
+                                At{imm_loc, Second(immediate)}});
+
+    case InstructionKind::Init:
+      return make(InitImmediate{At{imm_loc, First(immediate)},
+                                At{imm_loc, Second(immediate)}});
+
+    case InstructionKind::Let: {
+      auto block_type = extra.ReadBlockType();
+      auto locals = extra.ReadLocalsList();
+      return make(LetImmediate{block_type, std::move(locals)});
+    }
+
+    case InstructionKind::MemArg:
+      return make(MemArgImmediate{At{imm_loc, First(immediate)},
+                                  At{imm_loc, Second(immediate)}});
+
+    case InstructionKind::HeapType:
+      return make(*extra.ReadHeapType());
+
+    case InstructionKind::Select:
+      return make(extra.ReadValueTypeList());
+
+    case InstructionKind::Shuffle:
+      return make(extra.ReadArray<ShuffleImmediate>());
+
+    case InstructionKind::SimdLane:
+      return make(static_cast<SimdLaneImmediate>(immediate));
+
+    case InstructionKind::FuncBind:
+      return make(FuncBindImmediate{At{imm_loc, First(immediate)}});
+
+    case InstructionKind::BrOnCast: {
+      auto target = extra.ReadIndex();
+      return make(BrOnCastImmediate{target, extra.ReadHeapType2()});
+    }
+
+    case InstructionKind::HeapType2:
+      return make(extra.ReadHeapType2());
+
+    case InstructionKind::RttSub: {
+      auto depth = extra.ReadIndex();
+      return make(RttSubImmediate{depth, extra.ReadHeapType2()});
+    }
+
+    case InstructionKind::StructField:
+      return make(StructFieldImmediate{At{imm_loc, First(immediate)},
+                                       At{imm_loc, Second(immediate)}});
+  }
+  WASP_UNREACHABLE();
+}
+
+auto PackedExpression::ToInstructionList() const -> InstructionList {
+  InstructionList result;
+  result.reserve(size());
+  for (Index i = 0; i < size(); ++i) {
+    result.push_back((*this)[i]);
+  }
+  return result;
+}
+
+bool operator==(const PackedExpression& lhs, const PackedExpression& rhs) {
+  return lhs.opcodes_ == rhs.opcodes_ && lhs.kinds_ == rhs.kinds_ &&
+         lhs.immediates_ == rhs.immediates_ && lhs.extra_ == rhs.extra_;
+}
+
+bool operator!=(const PackedExpression& lhs, const PackedExpression& rhs) {
+  return !(lhs == rhs);
+}
+
 
 WASP_BINARY_STRUCTS_CUSTOM_FORMAT(WASP_OPERATOR_EQ_NE_VARGS)
 WASP_BINARY_CONTAINERS(WASP_OPERATOR_EQ_NE_CONTAINER)
@@ -926,7 +1455,8 @@ bool operator==(const Module& lhs, const Module& rhs) {
          lhs.start == rhs.start &&
          lhs.element_segments == rhs.element_segments &&
          lhs.data_count == rhs.data_count && lhs.codes == rhs.codes &&
-         lhs.data_segments == rhs.data_segments;
+         lhs.data_segments == rhs.data_segments &&
+         lhs.packed_codes == rhs.packed_codes;
 }
 
 bool operator!=(const Module& lhs, const Module& rhs) { return !(lhs == rhs); }
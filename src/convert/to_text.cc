@@ -633,6 +633,24 @@ auto ToText(TextCtx& ctx,
   return function;
 }
 
+auto ToText(TextCtx& ctx, const binary::PackedExpression& value)
+    -> text::InstructionList {
+  text::InstructionList result;
+  result.reserve(value.size());
+  for (Index i = 0; i < value.size(); ++i) {
+    result.push_back(ToText(ctx, value[i]));
+  }
+  return result;
+}
+
+auto ToText(TextCtx& ctx,
+            const At<binary::PackedCode>& value,
+            At<text::Function>& function) -> At<text::Function>& {
+  function->locals = ToText(ctx, value->locals);
+  function->instructions = ToText(ctx, value->body);
+  return function;
+}
+
 // Section 11: Data
 auto ToText(TextCtx& ctx, const At<SpanU8>& value) -> text::DataItemList {
   return text::DataItemList{text::DataItem{ctx.Add(ToStringView(value))}};
@@ -699,12 +717,23 @@ auto ToText(TextCtx& ctx, const At<binary::Module>& value) -> At<text::Module> {
   do_vector(value->element_segments);
   do_vector(value->data_segments);
 
-  // Combine binary::Function and binary::UnpackedCode into text::Function.
-  assert(value->functions.size() == value->codes.size());
-  for (size_t i = 0; i < value->functions.size(); ++i) {
-    At<text::Function> function = ToText(ctx, value->functions[i]);
-    module.push_back(At{function.loc(), text::ModuleItem{ToText(
-                                            ctx, value->codes[i], function)}});
+  // Combine binary::Function and binary::UnpackedCode (or
+  // binary::PackedCode) into text::Function.
+  if (!value->packed_codes.empty()) {
+    assert(value->functions.size() == value->packed_codes.size());
+    for (size_t i = 0; i < value->functions.size(); ++i) {
+      At<text::Function> function = ToText(ctx, value->functions[i]);
+      module.push_back(
+          At{function.loc(), text::ModuleItem{ToText(
+                                 ctx, value->packed_codes[i], function)}});
+    }
+  } else {
+    assert(value->functions.size() == value->codes.size());
+    for (size_t i = 0; i < value->functions.size(); ++i) {
+      At<text::Function> function = ToText(ctx, value->functions[i]);
+      module.push_back(At{function.loc(), text::ModuleItem{ToText(
+                                              ctx, value->codes[i], function)}});
+    }
   }
 
   return At{value.loc(), module};
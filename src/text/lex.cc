@@ -17,6 +17,17 @@
 #include "wasp/text/read/lex.h"
 
 #include <cassert>
+#include <cstring>
+
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#define WASP_LEX_SIMD 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define WASP_LEX_SIMD 1
+#endif
+#endif
 
 namespace wasp::text {
 
@@ -70,6 +81,200 @@ bool IsDigit(int c) { return IsCharClass(c, CharClass::Digit); }
 bool IsHexDigit(int c) { return IsCharClass(c, CharClass::HexDigit); }
 bool IsReserved(int c) { return IsCharClass(c, CharClass::Reserved); }
 
+// The scanners below find the end of a run of bytes in the lexer's hot loops:
+// whitespace, comments, text and reserved chars. Where SIMD is available, a
+// block of bytes is checked at once; each byte that matches the scanner's
+// condition sets a bit in a mask. The remaining bytes at the end, or all bytes
+// without SIMD, are checked one at a time.
+#if defined(WASP_LEX_SIMD)
+
+#if defined(__AVX2__)
+
+using ScanBlock = __m256i;
+constexpr span_extent_t kScanBlockSize = 32;
+constexpr u32 kFullScanMask = 0xffffffff;
+
+ScanBlock LoadBlock(const u8* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+ScanBlock MatchByte(ScanBlock block, u8 c) {
+  return _mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast<char>(c)));
+}
+
+// Matches bytes in the range [lo, hi].
+ScanBlock MatchRange(ScanBlock block, u8 lo, u8 hi) {
+  auto offset =
+      _mm256_sub_epi8(block, _mm256_set1_epi8(static_cast<char>(lo)));
+  auto max = _mm256_set1_epi8(static_cast<char>(hi - lo));
+  return _mm256_cmpeq_epi8(_mm256_max_epu8(offset, max), max);
+}
+
+ScanBlock Or(ScanBlock lhs, ScanBlock rhs) {
+  return _mm256_or_si256(lhs, rhs);
+}
+
+u32 ToMask(ScanBlock block) {
+  return static_cast<u32>(_mm256_movemask_epi8(block));
+}
+
+#elif defined(__SSE2__)
+
+using ScanBlock = __m128i;
+constexpr span_extent_t kScanBlockSize = 16;
+constexpr u32 kFullScanMask = 0xffff;
+
+ScanBlock LoadBlock(const u8* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+ScanBlock MatchByte(ScanBlock block, u8 c) {
+  return _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(c)));
+}
+
+// Matches bytes in the range [lo, hi].
+ScanBlock MatchRange(ScanBlock block, u8 lo, u8 hi) {
+  auto offset = _mm_sub_epi8(block, _mm_set1_epi8(static_cast<char>(lo)));
+  auto max = _mm_set1_epi8(static_cast<char>(hi - lo));
+  return _mm_cmpeq_epi8(_mm_max_epu8(offset, max), max);
+}
+
+ScanBlock Or(ScanBlock lhs, ScanBlock rhs) {
+  return _mm_or_si128(lhs, rhs);
+}
+
+u32 ToMask(ScanBlock block) {
+  return static_cast<u32>(_mm_movemask_epi8(block));
+}
+
+#else  // NEON
+
+using ScanBlock = uint8x16_t;
+constexpr span_extent_t kScanBlockSize = 16;
+constexpr u32 kFullScanMask = 0xffff;
+
+ScanBlock LoadBlock(const u8* p) {
+  return vld1q_u8(p);
+}
+
+ScanBlock MatchByte(ScanBlock block, u8 c) {
+  return vceqq_u8(block, vdupq_n_u8(c));
+}
+
+// Matches bytes in the range [lo, hi].
+ScanBlock MatchRange(ScanBlock block, u8 lo, u8 hi) {
+  return vcleq_u8(vsubq_u8(block, vdupq_n_u8(lo)), vdupq_n_u8(hi - lo));
+}
+
+ScanBlock Or(ScanBlock lhs, ScanBlock rhs) {
+  return vorrq_u8(lhs, rhs);
+}
+
+u32 ToMask(ScanBlock block) {
+  // NEON has no movemask, so give each byte its bit and add the halves.
+  static const uint8x16_t kBits = {1, 2, 4, 8, 16, 32, 64, 128,
+                                   1, 2, 4, 8, 16, 32, 64, 128};
+  auto bits = vandq_u8(block, kBits);
+  return vaddv_u8(vget_low_u8(bits)) |
+         (static_cast<u32>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+#endif
+
+#endif  // defined(WASP_LEX_SIMD)
+
+// Returns the number of bytes at the start of `data` before the first byte
+// for which `Scanner` stops, or data.size() if there is none.
+template <typename Scanner>
+span_extent_t Scan(SpanU8 data) {
+  span_extent_t pos = 0;
+#if defined(WASP_LEX_SIMD)
+  for (; pos + kScanBlockSize <= data.size(); pos += kScanBlockSize) {
+    u32 mask = Scanner::StopMask(LoadBlock(data.data() + pos));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; pos < data.size(); ++pos) {
+    if (Scanner::IsStop(data[pos])) {
+      break;
+    }
+  }
+  return pos;
+}
+
+// Stops at anything but whitespace.
+struct WhitespaceScanner {
+  static bool IsStop(u8 c) {
+    return !(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+  }
+
+#if defined(WASP_LEX_SIMD)
+  static u32 StopMask(ScanBlock block) {
+    auto whitespace = Or(Or(MatchByte(block, ' '), MatchByte(block, '\t')),
+                         Or(MatchByte(block, '\r'), MatchByte(block, '\n')));
+    return ~ToMask(whitespace) & kFullScanMask;
+  }
+#endif
+};
+
+// Stops at the chars that can begin or end a block comment.
+struct BlockCommentScanner {
+  static bool IsStop(u8 c) { return c == ';' || c == '('; }
+
+#if defined(WASP_LEX_SIMD)
+  static u32 StopMask(ScanBlock block) {
+    return ToMask(Or(MatchByte(block, ';'), MatchByte(block, '(')));
+  }
+#endif
+};
+
+// Stops at the chars in a string that aren't just copied.
+struct TextScanner {
+  static bool IsStop(u8 c) { return c == '"' || c == '\\' || c == '\n'; }
+
+#if defined(WASP_LEX_SIMD)
+  static u32 StopMask(ScanBlock block) {
+    return ToMask(Or(Or(MatchByte(block, '"'), MatchByte(block, '\\')),
+                     MatchByte(block, '\n')));
+  }
+#endif
+};
+
+// Stops at anything but a reserved char; see IsReserved.
+struct ReservedScanner {
+  static bool IsStop(u8 c) { return !IsReserved(c); }
+
+#if defined(WASP_LEX_SIMD)
+  static u32 StopMask(ScanBlock block) {
+    auto delimiters =
+        Or(Or(Or(MatchByte(block, '"'), MatchByte(block, '(')),
+              Or(MatchByte(block, ')'), MatchByte(block, ','))),
+           Or(Or(MatchByte(block, ';'), MatchByte(block, '[')),
+              Or(Or(MatchByte(block, ']'), MatchByte(block, '{')),
+                 MatchByte(block, '}'))));
+    return (~ToMask(MatchRange(block, '!', '~')) | ToMask(delimiters)) &
+           kFullScanMask;
+  }
+#endif
+};
+
+// Stops at the chars that can change the nesting depth, or begin a string or
+// comment; see SplitSExpressions.
+struct StructureScanner {
+  static bool IsStop(u8 c) {
+    return c == '(' || c == ')' || c == '"' || c == ';';
+  }
+
+#if defined(WASP_LEX_SIMD)
+  static u32 StopMask(ScanBlock block) {
+    return ToMask(Or(Or(MatchByte(block, '('), MatchByte(block, ')')),
+                     Or(MatchByte(block, '"'), MatchByte(block, ';'))));
+  }
+#endif
+};
+
 auto PeekChar(SpanU8* data, span_extent_t offset = 0) -> int {
   if (offset >= data->size()) {
     return -1;
@@ -83,12 +288,9 @@ void SkipChar(SpanU8* data) {
 }
 
 int ReadReservedChars(SpanU8* data) {
-  int count = 0;
-  while (IsReserved(PeekChar(data))) {
-    SkipChar(data);
-    ++count;
-  }
-  return count;
+  auto count = Scan<ReservedScanner>(*data);
+  data->remove_prefix(count);
+  return static_cast<int>(count);
 }
 
 bool NoTrailingReservedChars(SpanU8* data) {
@@ -166,9 +368,7 @@ bool MatchHexNum(SpanU8* data, HasUnderscores& has_underscores) {
 
 auto LexReserved(SpanU8* data) -> Token {
   MatchGuard guard{data};
-  while (IsReserved(PeekChar(data))) {
-    SkipChar(data);
-  }
+  ReadReservedChars(data);
   return Token(guard.loc(), TokenType::Reserved);
 }
 
@@ -182,6 +382,7 @@ auto LexBlockComment(SpanU8* data) -> Token {
   MatchGuard guard{data};
   int nesting = 0;
   while (true) {
+    data->remove_prefix(Scan<BlockCommentScanner>(*data));
     switch (ReadChar(data)) {
       case -1:
         return Token(guard.loc(), TokenType::InvalidBlockComment);
@@ -214,16 +415,15 @@ auto LexId(SpanU8* data) -> Token {
 
 auto LexLineComment(SpanU8* data) -> Token {
   MatchGuard guard{data};
-  while (true) {
-    switch (ReadChar(data)) {
-      case -1:
-        return Token(guard.loc(), TokenType::InvalidLineComment);
-
-      case '\n':
-        return Token(guard.loc(), TokenType::LineComment);
-      default: break;
-    }
+  // memchr is already vectorized by the C library.
+  auto* newline = static_cast<const u8*>(
+      std::memchr(data->data(), '\n', data->size()));
+  if (newline == nullptr) {
+    data->remove_prefix(data->size());
+    return Token(guard.loc(), TokenType::InvalidLineComment);
   }
+  data->remove_prefix(newline - data->data() + 1);
+  return Token(guard.loc(), TokenType::LineComment);
 }
 
 auto LexNameEqNum(SpanU8* data, string_view sv, TokenType tt) -> Token {
@@ -328,6 +528,9 @@ auto LexText(SpanU8* data) -> Token {
   bool in_string = true;
   u32 byte_size = 0;
   while (in_string) {
+    auto count = Scan<TextScanner>(*data);
+    data->remove_prefix(count);
+    byte_size += static_cast<u32>(count);
     switch (ReadChar(data)) {
       case -1:
         has_error = true;
@@ -405,22 +608,8 @@ auto LexText(SpanU8* data) -> Token {
 
 auto LexWhitespace(SpanU8* data) -> Token {
   MatchGuard guard{data};
-  while (true) {
-    switch (PeekChar(data)) {
-      case ' ':
-      case '\t':
-      case '\r':
-        SkipChar(data);
-        break;
-
-      case '\n':
-        SkipChar(data);
-        break;
-
-      default:
-        return Token(guard.loc(), TokenType::Whitespace);
-    }
-  }
+  data->remove_prefix(Scan<WhitespaceScanner>(*data));
+  return Token(guard.loc(), TokenType::Whitespace);
 }
 
 auto LexKeyword(SpanU8* data, string_view sv, TokenType tt) -> Token {
@@ -617,4 +806,63 @@ auto LexNoWhitespace(SpanU8* data) -> Token {
   }
 }
 
+auto SplitSExpressions(SpanU8 data) -> std::vector<SpanU8> {
+  std::vector<SpanU8> result;
+  const u8* start = nullptr;
+  int depth = 0;
+  while (true) {
+    data.remove_prefix(depth == 0 ? Scan<WhitespaceScanner>(data)
+                                  : Scan<StructureScanner>(data));
+    switch (PeekChar(&data)) {
+      case -1:
+        return result;
+
+      case '(':
+        if (PeekChar(&data, 1) == ';') {
+          if (LexBlockComment(&data).type == TokenType::InvalidBlockComment) {
+            return result;
+          }
+        } else {
+          if (depth++ == 0) {
+            start = data.begin();
+          }
+          SkipChar(&data);
+        }
+        break;
+
+      case ')':
+        if (depth == 0) {
+          return result;
+        }
+        SkipChar(&data);
+        if (--depth == 0) {
+          result.push_back(MakeSpan(start, data.begin()));
+        }
+        break;
+
+      case ';':
+        if (PeekChar(&data, 1) == ';') {
+          LexLineComment(&data);
+        } else if (depth == 0) {
+          return result;
+        } else {
+          SkipChar(&data);
+        }
+        break;
+
+      case '"':
+        if (depth == 0) {
+          return result;
+        }
+        LexText(&data);
+        break;
+
+      default:
+        // Only reachable at the top level, where anything but whitespace,
+        // comments and s-expressions ends the split.
+        return result;
+    }
+  }
+}
+
 }  // namespace wasp::text
@@ -16,7 +16,9 @@
 
 #include "wasp/text/read/name_map.h"
 
+#include <algorithm>
 #include <cassert>
+
 #include "wasp/base/macros.h"
 
 namespace wasp::text {
@@ -25,64 +27,77 @@ NameMap::NameMap() : stack_{0} {}
 
 void NameMap::Reset() {
   names_.clear();
+  shadowed_.clear();
   stack_ = {0};
+  positions_.clear();
 }
 
 void NameMap::NewUnbound() {
   names_.push_back(nullopt);
+  shadowed_.push_back(kNone);
 }
 
 bool NameMap::NewBound(BindVar var) {
-  if (HasSinceLastPush(var)) {
+  auto position = static_cast<Index>(names_.size());
+  auto [iter, inserted] = positions_.try_emplace(var, position);
+  if (inserted) {
+    shadowed_.push_back(kNone);
+  } else if (iter->second >= stack_.back()) {
     return false;
+  } else {
+    shadowed_.push_back(iter->second);
+    iter->second = position;
   }
   names_.push_back(var);
   return true;
 }
 
 void NameMap::Push() {
-  stack_.push_back(names_.size());
+  stack_.push_back(static_cast<Index>(names_.size()));
 }
 
 void NameMap::Pop() {
   assert(stack_.size() > 1);
+  for (auto i = static_cast<Index>(names_.size()); i > stack_.back(); --i) {
+    auto&& opt_name = names_[i - 1];
+    if (opt_name) {
+      if (shadowed_[i - 1] == kNone) {
+        positions_.erase(*opt_name);
+      } else {
+        positions_[*opt_name] = shadowed_[i - 1];
+      }
+    }
+  }
   names_.resize(stack_.back());
+  shadowed_.resize(stack_.back());
   stack_.pop_back();
 }
 
 bool NameMap::Has(BindVar var) const {
-  return FindInRange(0, names_.size(), var).has_value();
+  return Find(var) != kNone;
 }
 
 bool NameMap::HasSinceLastPush(BindVar var) const {
-  return FindInRange(stack_.back(), names_.size(), var).has_value();
+  auto position = Find(var);
+  return position != kNone && position >= stack_.back();
 }
 
-optional<size_t> NameMap::FindInRange(size_t begin,
-                                      size_t end,
-                                      BindVar var) const {
-  for (size_t i = begin; i < end; ++i) {
-    auto&& opt_name = names_[i];
-    if (opt_name && opt_name == var) {
-      return i;
-    }
-  }
-  return nullopt;
+auto NameMap::Find(BindVar var) const -> Index {
+  auto iter = positions_.find(var);
+  return iter != positions_.end() ? iter->second : kNone;
 }
 
 optional<Index> NameMap::Get(BindVar var) const {
-  Index offset = 0;
-  size_t end = names_.size();
-  for (auto iter = stack_.rbegin(); iter != stack_.rend(); ++iter) {
-    size_t begin = *iter;
-    auto found = FindInRange(begin, end, var);
-    if (found) {
-      return offset + static_cast<Index>(*found - begin);
-    }
-    offset += static_cast<Index>(end - begin);
-    end = begin;
+  auto position = Find(var);
+  if (position == kNone) {
+    return nullopt;
   }
-  return nullopt;
+  // The scope that contains `position` is the last one that begins at or
+  // before it. Its names are numbered after those of all inner scopes.
+  auto scope = std::upper_bound(stack_.begin(), stack_.end(), position) - 1;
+  Index begin = *scope;
+  Index end = scope + 1 != stack_.end() ? *(scope + 1) : Size();
+  return position - begin + (Size() - end);
 }
 
 auto NameMap::Size() const -> Index {
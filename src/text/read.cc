@@ -21,12 +21,17 @@
 #include <iterator>
 #include <numeric>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "wasp/base/buffered_errors.h"
 #include "wasp/base/concat.h"
 #include "wasp/base/errors.h"
+#include "wasp/base/parallel_for.h"
 #include "wasp/base/utf8.h"
 #include "wasp/text/formatters.h"
 #include "wasp/text/numeric.h"
+#include "wasp/text/read/lex.h"
 #include "wasp/text/read/location_guard.h"
 #include "wasp/text/read/macros.h"
 #include "wasp/text/read/read_ctx.h"
@@ -2257,12 +2262,123 @@ auto ReadModule(Tokenizer& tokenizer, ReadCtx& ctx) -> optional<Module> {
   Module module;
   while (IsModuleItem(tokenizer)) {
     WASP_TRY_READ(item, ReadModuleItem(tokenizer, ctx));
-    module.push_back(item);
+    module.push_back(std::move(item.value()));
+  }
+  return module;
+}
+
+namespace {
+
+// The result of reading one top-level field on its own, for
+// ReadModuleParallel.
+struct FieldResult {
+  explicit FieldResult(bool has_context) : errors{has_context} {}
+
+  optional<ModuleItem> item;
+  BufferedErrors errors;
+  Token last;             // The last token read, for Tokenizer::Seek.
+  bool complete = false;  // The item was read, and used the whole field.
+  bool seen_non_import = false;
+  bool seen_start = false;
+};
+
+bool MayImport(TokenType kind, const FieldResult& result) {
+  switch (kind) {
+    case TokenType::Import:
+      return true;
+
+    case TokenType::Func:
+    case TokenType::Table:
+    case TokenType::Memory:
+    case TokenType::Global:
+    case TokenType::Event:
+      // Inline imports don't set seen_non_import.
+      return !result.seen_non_import;
+
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+auto ReadModuleParallel(Tokenizer& tokenizer, ReadCtx& ctx, int jobs)
+    -> optional<Module> {
+  if (jobs <= 1) {
+    return ReadModule(tokenizer, ctx);
+  }
+
+  ctx.BeginModule();
+
+  // Only module items can be read on their own; stop at anything else.
+  auto fields = SplitSExpressions(tokenizer.Remaining());
+  std::vector<TokenType> kinds;
+  for (auto field : fields) {
+    Tokenizer field_tokenizer{field};
+    if (!IsModuleItem(field_tokenizer)) {
+      break;
+    }
+    kinds.push_back(field_tokenizer.Peek(1).type);
+  }
+
+  const auto count = static_cast<Index>(kinds.size());
+  std::vector<FieldResult> results;
+  results.reserve(count);
+  for (Index index = 0; index < count; ++index) {
+    results.emplace_back(ctx.errors.has_context());
+  }
+
+  // Each field is read as if it were the first in the module.
+  ParallelFor(count, jobs, [&](Index index, Index) {
+    auto& result = results[index];
+    Tokenizer field_tokenizer{fields[index]};
+    ReadCtx field_ctx{ctx.features, result.errors};
+    if (auto item = ReadModuleItem(field_tokenizer, field_ctx)) {
+      result.item = std::move(item->value());
+      result.complete = field_tokenizer.Peek().type == TokenType::Eof;
+    }
+    result.last = field_tokenizer.Previous();
+    result.seen_non_import = field_ctx.seen_non_import;
+    result.seen_start = field_ctx.seen_start;
+  });
+
+  // Take the fields in order, until one that failed or that depends on the
+  // fields before it (an import after a non-import, or a second start). That
+  // field and the rest are read serially, so the errors are the same as for
+  // ReadModule.
+  Module module;
+  module.reserve(count);
+  Index index = 0;
+  for (; index < count; ++index) {
+    auto& result = results[index];
+    if (!result.complete ||
+        (ctx.seen_non_import && MayImport(kinds[index], result)) ||
+        (ctx.seen_start && kinds[index] == TokenType::Start)) {
+      break;
+    }
+    result.errors.ReplayInto(ctx.errors);
+    module.push_back(std::move(*result.item));
+    ctx.seen_non_import |= result.seen_non_import;
+    ctx.seen_start |= result.seen_start;
+  }
+
+  if (index > 0) {
+    tokenizer.Seek(fields[index - 1].end(), results[index - 1].last);
+  }
+
+  while (IsModuleItem(tokenizer)) {
+    WASP_TRY_READ(item, ReadModuleItem(tokenizer, ctx));
+    module.push_back(std::move(item.value()));
   }
   return module;
 }
 
 auto ReadSingleModule(Tokenizer& tokenizer, ReadCtx& ctx) -> optional<Module> {
+  return ReadSingleModuleParallel(tokenizer, ctx, 1);
+}
+
+auto ReadSingleModuleParallel(Tokenizer& tokenizer, ReadCtx& ctx, int jobs)
+    -> optional<Module> {
   // Check whether it's wrapped in (module... )
   bool in_module = false;
   if (tokenizer.MatchLpar(TokenType::Module).has_value()) {
@@ -2271,7 +2387,7 @@ auto ReadSingleModule(Tokenizer& tokenizer, ReadCtx& ctx) -> optional<Module> {
     ReadModuleVarOpt(tokenizer, ctx);
   }
 
-  auto module = ReadModule(tokenizer, ctx);
+  auto module = ReadModuleParallel(tokenizer, ctx, jobs);
 
   if (in_module) {
     WASP_TRY(Expect(tokenizer, ctx, TokenType::Rpar));
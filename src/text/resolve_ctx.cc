@@ -19,11 +19,67 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <utility>
 
 #include "wasp/base/macros.h"
 
 namespace wasp::text {
 
+namespace {
+
+// These hash only values, not locations, to match FunctionTypeMap::IsSame.
+template <typename H>
+H HashHeapType(H h, const HeapType& type) {
+  if (type.is_heap_kind()) {
+    return H::combine(std::move(h), 0, type.heap_kind().value());
+  }
+  const Var& var = type.var().value();
+  if (var.is_index()) {
+    return H::combine(std::move(h), 1, var.index());
+  }
+  return H::combine(std::move(h), 2, var.name());
+}
+
+template <typename H>
+H HashValueType(H h, const ValueType& type) {
+  if (type.is_numeric_type()) {
+    return H::combine(std::move(h), 0, type.numeric_type().value());
+  } else if (type.is_reference_type()) {
+    const auto& reference_type = type.reference_type().value();
+    if (reference_type.is_reference_kind()) {
+      return H::combine(std::move(h), 1,
+                        reference_type.reference_kind().value());
+    }
+    const auto& ref = reference_type.ref().value();
+    return HashHeapType(H::combine(std::move(h), 2, ref.null),
+                        ref.heap_type.value());
+  } else {
+    const auto& rtt = type.rtt().value();
+    return HashHeapType(H::combine(std::move(h), 3, rtt.depth.value()),
+                        rtt.type.value());
+  }
+}
+
+template <typename H>
+H HashValueTypes(H h, const ValueTypeList& types) {
+  for (auto&& type : types) {
+    h = HashValueType(std::move(h), type.value());
+  }
+  return H::combine(std::move(h), types.size());
+}
+
+struct HashedFunctionType {
+  template <typename H>
+  friend H AbslHashValue(H h, const HashedFunctionType& value) {
+    return HashValueTypes(HashValueTypes(std::move(h), value.type.params),
+                          value.type.results);
+  }
+
+  const FunctionType& type;
+};
+
+}  // namespace
+
 ResolveCtx::ResolveCtx(Errors& errors) : errors{errors} {}
 
 void ResolveCtx::BeginModule() {
@@ -85,10 +141,14 @@ auto ResolveCtx::GetFieldNameMap(Index index) -> NameMap* {
 void FunctionTypeMap::BeginModule() {
   list_.clear();
   deferred_list_.clear();
+  list_map_.clear();
+  deferred_map_.clear();
 }
 
 void FunctionTypeMap::Define(BoundFunctionType bound_type) {
-  list_.push_back(ToFunctionType(bound_type));
+  auto type = ToFunctionType(bound_type);
+  list_map_.try_emplace(type, static_cast<Index>(list_.size()));
+  list_.push_back(std::move(type));
 }
 
 void FunctionTypeMap::SkipIndex() {
@@ -96,17 +156,16 @@ void FunctionTypeMap::SkipIndex() {
 }
 
 Index FunctionTypeMap::Use(FunctionType type) {
-  auto iter = FindIter(list_, type);
-  if (iter != list_.end()) {
-    return static_cast<Index>(iter - list_.begin());
+  if (auto index = Find(list_map_, type)) {
+    return *index;
   }
 
-  iter = FindIter(deferred_list_, type);
-  if (iter != deferred_list_.end()) {
-    return static_cast<Index>(list_.size() + (iter - deferred_list_.begin()));
+  if (auto index = Find(deferred_map_, type)) {
+    return static_cast<Index>(list_.size() + *index);
   }
 
-  deferred_list_.push_back(type);
+  deferred_map_.try_emplace(type, static_cast<Index>(deferred_list_.size()));
+  deferred_list_.push_back(std::move(type));
   return static_cast<Index>(list_.size() + deferred_list_.size() - 1);
 }
 
@@ -118,10 +177,12 @@ auto FunctionTypeMap::EndModule() -> DefinedTypeList {
   DefinedTypeList defined_types;
   for (auto&& deferred : deferred_list_) {
     assert(deferred.has_value());
+    list_map_.try_emplace(*deferred, static_cast<Index>(list_.size()));
     list_.push_back(*deferred);
     defined_types.push_back(ToDefinedType(*deferred));
   }
   deferred_list_.clear();
+  deferred_map_.clear();
   return defined_types;
 }
 
@@ -152,13 +213,22 @@ DefinedType FunctionTypeMap::ToDefinedType(const FunctionType& unbound_type) {
 }
 
 // static
-FunctionTypeMap::List::const_iterator FunctionTypeMap::FindIter(
-    const List& list,
-    const FunctionType& type) {
-  return std::find_if(list.begin(), list.end(),
-                      [&](const optional<FunctionType>& ft) {
-                        return ft && IsSame(type, *ft);
-                      });
+optional<Index> FunctionTypeMap::Find(const IndexMap& map,
+                                      const FunctionType& type) {
+  auto iter = map.find(type);
+  if (iter == map.end()) {
+    return nullopt;
+  }
+  return iter->second;
+}
+
+size_t FunctionTypeMap::Hash::operator()(const FunctionType& type) const {
+  return absl::Hash<HashedFunctionType>{}(HashedFunctionType{type});
+}
+
+bool FunctionTypeMap::Eq::operator()(const FunctionType& lhs,
+                                     const FunctionType& rhs) const {
+  return IsSame(lhs, rhs);
 }
 
 // static
@@ -0,0 +1,121 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/text/read/token_buffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <type_traits>
+
+#include "wasp/base/variant.h"
+#include "wasp/text/read/lex.h"
+
+namespace wasp::text {
+
+namespace {
+
+// OpcodeInfo's features are stored in PackedToken::extra.
+constexpr int kFeatureCount = 0
+#define WASP_V(enum_, variable, flag, default_) + 1
+#include "wasp/base/features.inc"
+#undef WASP_V
+    ;
+static_assert(kFeatureCount <= std::numeric_limits<u16>::digits);
+
+// PackedToken::immediate_index is the index of the Token::Immediate
+// alternative, and TokenBuffer::Get switches on it.
+template <size_t N, typename T>
+constexpr bool kIsImmediate =
+    std::is_same_v<variant_alternative_t<N, Token::Immediate>, T>;
+static_assert(variant_size<Token::Immediate>::value == 9);
+static_assert(kIsImmediate<0, monostate>);
+static_assert(kIsImmediate<1, OpcodeInfo>);
+static_assert(kIsImmediate<2, NumericType>);
+static_assert(kIsImmediate<3, ReferenceKind>);
+static_assert(kIsImmediate<4, HeapKind>);
+static_assert(kIsImmediate<5, PackedType>);
+static_assert(kIsImmediate<6, LiteralInfo>);
+static_assert(kIsImmediate<7, Text>);
+static_assert(kIsImmediate<8, SimdShape>);
+
+}  // namespace
+
+TokenBuffer::TokenBuffer(SpanU8 data) : data_{data} {
+  if (data.size() > kMaxSize) {
+    return;
+  }
+  // Typical .wat averages roughly one token per 8-10 bytes.
+  tokens_.reserve(data.size() / 8 + 1);
+  while (true) {
+    auto token = LexNoWhitespace(&data);
+    tokens_.push_back(Pack(data_, token));
+    if (token.type == TokenType::Eof) {
+      break;
+    }
+  }
+}
+
+auto TokenBuffer::Find(const u8* position) const -> Index {
+  auto offset = static_cast<u32>(position - data_.begin());
+  auto iter = std::lower_bound(
+      tokens_.begin(), tokens_.end(), offset,
+      [](const PackedToken& token, u32 offset) {
+        return token.offset < offset;
+      });
+  return static_cast<Index>(iter - tokens_.begin());
+}
+
+// static
+auto TokenBuffer::Pack(SpanU8 data, const Token& token) -> PackedToken {
+  PackedToken packed;
+  packed.offset = static_cast<u32>(token.loc.begin() - data.begin());
+  packed.size = static_cast<u32>(token.loc.size());
+  packed.immediate = 0;
+  packed.extra = 0;
+  packed.type = static_cast<u8>(token.type);
+  packed.immediate_index = static_cast<u8>(token.immediate.index());
+
+  if (token.has_opcode()) {
+    auto info = get<OpcodeInfo>(token.immediate);
+    packed.immediate = static_cast<u32>(info.opcode);
+    packed.extra = static_cast<u16>(info.features.bits());
+  } else if (token.has_numeric_type()) {
+    packed.immediate = static_cast<u32>(get<NumericType>(token.immediate));
+  } else if (token.has_reference_kind()) {
+    packed.immediate = static_cast<u32>(get<ReferenceKind>(token.immediate));
+  } else if (token.has_heap_kind()) {
+    packed.immediate = static_cast<u32>(get<HeapKind>(token.immediate));
+  } else if (token.has_packed_type()) {
+    packed.immediate = static_cast<u32>(get<PackedType>(token.immediate));
+  } else if (token.has_literal_info()) {
+    auto info = token.literal_info();
+    packed.immediate = static_cast<u32>(info.sign) |
+                       (static_cast<u32>(info.kind) << 8) |
+                       (static_cast<u32>(info.base) << 16) |
+                       (static_cast<u32>(info.has_underscores) << 24);
+  } else if (token.has_text()) {
+    // The lexer always makes the text span the whole token.
+    auto text = token.text();
+    assert(text.text == token.as_string_view());
+    packed.immediate = text.byte_size;
+  } else if (token.has_simd_shape()) {
+    packed.immediate = static_cast<u32>(token.simd_shape());
+  }
+  return packed;
+}
+
+}  // namespace wasp::text
@@ -18,9 +18,12 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 #include "absl/strings/str_format.h"
 
+#include "wasp/base/str_to_u32.h"
+
 namespace wasp::tools {
 
 using absl::StrFormat;
@@ -83,6 +86,18 @@ ArgParser& ArgParser::AddFeatureFlags(Features& features) {
   return *this;
 }
 
+ArgParser& ArgParser::AddJobsFlag(int& jobs, Help help) {
+  return Add('j', "--jobs", "<count>", help, [&](string_view arg) {
+    auto count = StrToU32(arg);
+    if (!count || *count == 0 ||
+        *count > static_cast<u32>(std::numeric_limits<int>::max())) {
+      Format(&std::cerr, "Invalid job count: %s\n", arg);
+      PrintHelpAndExit(1);
+    }
+    jobs = static_cast<int>(*count);
+  });
+}
+
 void ArgParser::Parse(span<const string_view> args) {
   ArgsGuard guard{*this, args};
 
@@ -109,7 +124,7 @@ void ArgParser::Parse(span<const string_view> args) {
       } else {
         Format(&std::cerr, "Unknown long argument `%s`.\n", arg);
       }
-    } else if (arg[0] == '-') {
+    } else if (arg[0] == '-' && arg.size() > 1) {
       optional<char> prev_arg_with_param;
       for (auto c : arg.substr(1)) {
         if (prev_arg_with_param) {
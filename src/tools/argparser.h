@@ -70,6 +70,10 @@ class ArgParser {
 
   ArgParser& AddFeatureFlags(Features&);
 
+  // Add `-j <count>`, `--jobs <count>`. Exits with an error if <count> is not
+  // a positive number.
+  ArgParser& AddJobsFlag(int& jobs, Help);
+
   void Parse(span<const string_view>);
   span<const string_view> RestOfArgs();
 
@@ -14,7 +14,6 @@
 // limitations under the License.
 //
 
-#include <cassert>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -34,7 +33,7 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
-#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/instruction_scanner.h"
 #include "wasp/binary/lazy_module.h"
 #include "wasp/binary/lazy_module_utils.h"
 #include "wasp/binary/name_section/sections.h"
@@ -115,13 +114,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Sequential);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data{optfile->span()};
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -180,11 +179,10 @@ void Tool::CalculateCallGraph() {
       if (known->id == SectionId::Code) {
         auto section = ReadCodeSection(known, module.ctx);
         for (auto code : enumerate(section.sequence, imported_function_count)) {
-          for (const auto& instr :
-               ReadExpression(code.value->body, module.ctx)) {
-            if (instr->opcode == Opcode::Call) {
-              assert(instr->has_index_immediate());
-              auto callee_index = instr->index_immediate();
+          InstructionScanner scanner{code.value->body->data, module.ctx};
+          while (scanner.Next()) {
+            if (scanner.opcode() == Opcode::Call) {
+              auto callee_index = scanner.index_immediate();
               if (options.mode == Mode::Callers) {
                 full_graph.emplace(callee_index, code.index);
               } else {
@@ -34,7 +34,9 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
+#include "wasp/binary/code_index.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/instruction_scanner.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
 #include "wasp/binary/lazy_module_utils.h"
@@ -102,7 +104,7 @@ struct Tool {
   Options options;
   LazyModule module;
   std::map<string_view, Index> name_to_function;
-  Index imported_function_count = 0;
+  CodeIndex code_index;
   std::vector<Label> labels;
   std::vector<BasicBlock> cfg;
   BBID start_bbid = InvalidBBID;
@@ -141,13 +143,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Normal);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data{optfile->span()};
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -181,7 +183,7 @@ void Tool::DoPrepass() {
   ForEachFunctionName(module, [this](const IndexNamePair& pair) {
     name_to_function.insert(std::make_pair(pair.second, pair.first));
   });
-  imported_function_count = GetImportCount(module, ExternalKind::Function);
+  code_index = ReadCodeIndex(module);
 }
 
 optional<Index> Tool::GetFunctionIndex() {
@@ -196,18 +198,8 @@ optional<Index> Tool::GetFunctionIndex() {
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.ctx);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  if (auto code = code_index.GetCode(find_index, module.ctx)) {
+    return code->value();
   }
   return nullopt;
 }
@@ -219,19 +211,18 @@ void Tool::CalculateCFG(Code code) {
   StartBasicBlock(start_bbid, ptr);
 
   const u8* prev_ptr = ptr;
-  auto instrs = ReadExpression(code.body, module.ctx);
-  for (auto it = instrs.begin(), end = instrs.end(); it != end;
-       ++it, prev_ptr = ptr) {
-    const auto& instr = *it;
-    ptr = it.data().data();
-    switch (instr->opcode) {
+  InstructionScanner scanner{code.body->data, module.ctx};
+  for (; scanner.Next(); prev_ptr = ptr) {
+    Opcode opcode = scanner.opcode();
+    ptr = scanner.instruction().end();
+    switch (opcode) {
       case Opcode::Unreachable:
         MarkUnreachable(ptr);
         break;
 
       case Opcode::Block: {
         auto next = NewBasicBlock();
-        PushLabel(instr->opcode, next, next);
+        PushLabel(opcode, next, next);
         break;
       }
 
@@ -239,7 +230,7 @@ void Tool::CalculateCFG(Code code) {
         auto loop = NewBasicBlock();
         auto next = NewBasicBlock();
         AddSuccessor(loop);
-        PushLabel(instr->opcode, loop, next);
+        PushLabel(opcode, loop, next);
         StartBasicBlock(loop, prev_ptr);
         break;
       }
@@ -248,7 +239,7 @@ void Tool::CalculateCFG(Code code) {
         auto true_ = NewBasicBlock();
         auto next = NewBasicBlock();
         AddSuccessor(true_, "T");
-        PushLabel(instr->opcode, next, next);
+        PushLabel(opcode, next, next);
         StartBasicBlock(true_, ptr);
         break;
       }
@@ -258,7 +249,7 @@ void Tool::CalculateCFG(Code code) {
         AddSuccessor(top.next);
         auto false_ = NewBasicBlock();
         AddSuccessor(top.parent, false_, "F");
-        PushLabel(instr->opcode, top.next, top.next);
+        PushLabel(opcode, top.next, top.next);
         StartBasicBlock(false_, ptr);
         break;
       }
@@ -274,12 +265,12 @@ void Tool::CalculateCFG(Code code) {
       }
 
       case Opcode::Br:
-        Br(instr->index_immediate());
+        Br(scanner.index_immediate());
         MarkUnreachable(ptr);
         break;
 
       case Opcode::BrIf: {
-        Br(instr->index_immediate(), "T");
+        Br(scanner.index_immediate(), "T");
         auto next = NewBasicBlock();
         AddSuccessor(next, "F");
         StartBasicBlock(next, ptr);
@@ -287,12 +278,10 @@ void Tool::CalculateCFG(Code code) {
       }
 
       case Opcode::BrTable: {
-        const auto& immediate = instr->br_table_immediate();
         u32 value = 0;
-        for (const auto& target : immediate->targets) {
-          Br(target, StrFormat("%d", value++));
-        }
-        Br(immediate->default_target, "default");
+        Index default_target = scanner.ForEachBrTableTarget(
+            [&](Index target) { Br(target, StrFormat("%d", value++)); });
+        Br(default_target, "default");
         MarkUnreachable(ptr);
         break;
       }
@@ -356,8 +345,7 @@ void Tool::RemoveEmptyBasicBlocks() {
   }
 }
 
-bool IsExtraneousInstruction(const At<Instruction>& instr) {
-  auto opcode = instr->opcode;
+bool IsExtraneousInstruction(Opcode opcode) {
   return opcode == Opcode::Block || opcode == Opcode::Else ||
          opcode == Opcode::End || opcode == Opcode::Br;
 }
@@ -388,7 +376,7 @@ void Tool::WriteDotFile() {
              bb.index, colspan);
       auto instrs = ReadExpression(bb.value.code, module.ctx);
       for (const auto& instr: instrs) {
-        if (IsExtraneousInstruction(instr)) {
+        if (IsExtraneousInstruction(instr->opcode)) {
           continue;
         } else if (instr->opcode == Opcode::BrTable) {
           Format(stream, "%s...", concat(instr->opcode));
@@ -485,10 +473,13 @@ void Tool::EndBasicBlock(const u8* end) {
   const u8* start = bb.code.data();
   bb.code = MakeSpan(start, end);
 
-  auto instrs = ReadExpression(bb.code, module.ctx);
-  if (std::all_of(instrs.begin(), instrs.end(), IsExtraneousInstruction)) {
-    bb.code = SpanU8{};
+  InstructionScanner scanner{bb.code, module.ctx};
+  while (scanner.Next()) {
+    if (!IsExtraneousInstruction(scanner.opcode())) {
+      return;
+    }
   }
+  bb.code = SpanU8{};
 }
 
 void Tool::MarkUnreachable(const u8* ptr) {
@@ -34,6 +34,7 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
+#include "wasp/binary/code_index.h"
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
@@ -147,6 +148,7 @@ struct Tool {
   std::vector<Function> functions;
   std::map<string_view, Index> name_to_function;
   Index imported_function_count = 0;
+  CodeIndex code_index;
   std::vector<Label> labels;
   std::vector<Block> bbs;
   std::vector<Value> values;
@@ -189,13 +191,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Normal);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data{optfile->span()};
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -257,6 +259,11 @@ void Tool::DoPrepass() {
           break;
         }
 
+        case SectionId::Code:
+          code_index = CodeIndex{known->data, module.ctx,
+                                 imported_function_count};
+          break;
+
         default:
           break;
       }
@@ -291,18 +298,8 @@ optional<FunctionType> Tool::GetFunctionType(Index func_index) {
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.ctx);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  if (auto code = code_index.GetCode(find_index, module.ctx)) {
+    return code->value();
   }
   return nullopt;
 }
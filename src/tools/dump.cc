@@ -27,6 +27,7 @@
 #include "src/tools/binary_errors.h"
 #include "wasp/base/concat.h"
 #include "wasp/base/enumerate.h"
+#include "wasp/base/errors_nop.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
@@ -34,6 +35,7 @@
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
+#include "wasp/binary/code_index.h"
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
@@ -118,6 +120,7 @@ struct Tool {
     Tool& tool;
     Pass pass;
     SectionIndex section_index = 0;
+    SpanU8 section_data;
     Index index = 0;
     Index function_count = 0;
     Index table_count = 0;
@@ -244,13 +247,13 @@ int Main(span<const string_view> args) {
   }
 
   for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
+    auto optfile = MapFile(filename, FileAccess::Sequential);
+    if (!optfile) {
       Format(&std::cerr, "Error reading file %s.\n", filename);
       continue;
     }
 
-    SpanU8 data{*optbuf};
+    SpanU8 data{optfile->span()};
     Tool tool{filename, data, options};
     tool.Run();
     tool.errors.PrintTo(std::cerr);
@@ -447,6 +450,7 @@ Tool::Visitor::Visitor(Tool& tool, Pass pass) : tool{tool}, pass{pass} {}
 
 visit::Result Tool::Visitor::OnSection(At<Section> section) {
   auto this_idx = section_index++;
+  section_data = section->data();
   if (tool.SectionMatches(section)) {
     tool.DoSectionHeader(pass, section);
     if (section->is_custom()) {
@@ -750,7 +754,24 @@ visit::Result Tool::Visitor::BeginDataCountSection(DataCountSection section) {
 visit::Result Tool::Visitor::BeginCodeSection(LazyCodeSection section) {
   index = tool.imported_function_count;
   tool.DoCount(pass, section.count);
-  return SkipUnless(tool.ShouldPrintDetails(pass) || pass == Pass::Disassemble);
+  if (!(tool.ShouldPrintDetails(pass) || pass == Pass::Disassemble)) {
+    return visit::Result::Skip;
+  }
+
+  if (tool.options.func_index) {
+    // Only one function is printed, so jump straight to it. Any errors in the
+    // section count were already reported above.
+    ErrorsNop errors;
+    ReadCtx ctx{tool.options.features, errors};
+    CodeIndex code_index{section_data, ctx, tool.imported_function_count};
+    if (auto code =
+            code_index.GetCode(*tool.options.func_index, tool.module.ctx)) {
+      index = *tool.options.func_index;
+      BeginCode(*code);
+    }
+    return visit::Result::Skip;
+  }
+  return visit::Result::Ok;
 }
 
 visit::Result Tool::Visitor::BeginCode(const At<Code>& code) {
@@ -50,12 +50,15 @@ using namespace ::wasp::binary;
 struct Options {
   Features features;
   bool verbose = false;
+  bool stats = false;
+  int jobs = 1;
 };
 
 struct Tool {
   explicit Tool(string_view filename, SpanU8 data, Options);
 
   bool Run();
+  void PrintStats();
 
   std::string filename;
   Options options;
@@ -75,6 +78,9 @@ int Main(span<const string_view> args) {
            [&]() { parser.PrintHelpAndExit(0); })
       .Add('v', "--verbose", "print filename and whether it was valid",
            [&]() { options.verbose = true; })
+      .AddJobsFlag(options.jobs, "validate functions on <count> threads")
+      .Add("--stats", "print stack, local and call counts for each function",
+           [&]() { options.stats = true; })
       .AddFeatureFlags(options.features)
       .Add("<filenames...>", "input wasm files",
            [&](string_view arg) { filenames.push_back(arg); });
@@ -87,20 +93,23 @@ int Main(span<const string_view> args) {
 
   bool ok = true;
   for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
+    auto optfile = MapFile(filename, FileAccess::Sequential);
+    if (!optfile) {
       Format(&std::cerr, "Error reading file %s.\n", filename);
       ok = false;
       continue;
     }
 
-    SpanU8 data{*optbuf};
+    SpanU8 data{optfile->span()};
     Tool tool{filename, data, options};
     bool valid = tool.Run();
     if (!valid || options.verbose) {
       PrintF("[%4s] %s\n", valid ? " OK " : "FAIL", filename);
       tool.errors.PrintTo(std::cerr);
     }
+    if (options.stats) {
+      tool.PrintStats();
+    }
     ok &= valid;
   }
 
@@ -113,7 +122,9 @@ Tool::Tool(string_view filename, SpanU8 data, Options options)
       data{data},
       errors{data},
       module{ReadLazyModule(data, options.features, errors)},
-      visitor{options.features, errors} {}
+      visitor{options.features, errors, options.jobs} {
+  visitor.collect_function_stats = options.stats;
+}
 
 bool Tool::Run() {
   if (module.magic && module.version) {
@@ -122,6 +133,20 @@ bool Tool::Run() {
   return !errors.HasError();
 }
 
+void Tool::PrintStats() {
+  PrintF("%s:\n", filename);
+  PrintF("%8s %8s %8s %9s %9s %11s %12s %8s %8s\n", "func", "instrs",
+         "locals", "max stack", "max depth", "local reads", "local writes",
+         "calls", "memory");
+  Index func_index = visitor.ctx.imported_function_count;
+  for (const auto& stats : visitor.function_stats) {
+    PrintF("%8u %8u %8u %9u %9u %11u %12u %8u %8u\n", func_index++,
+           stats.instruction_count, stats.local_count, stats.max_stack_height,
+           stats.max_label_depth, stats.local_reads, stats.local_writes,
+           stats.calls, stats.memory_accesses);
+  }
+}
+
 }  // namespace validate
 }  // namespace tools
 }  // namespace wasp
@@ -53,6 +53,7 @@ using absl::Format;
 struct Options {
   Features features;
   bool validate = true;
+  int jobs = 1;
   optional<std::string> output_filename;
 };
 
@@ -80,6 +81,7 @@ int Main(span<const string_view> args) {
            [&](string_view arg) { options.output_filename = arg; })
       .Add("--no-validate", "Don't validate before writing",
            [&]() { options.validate = false; })
+      .AddJobsFlag(options.jobs, "decode functions on <count> threads")
       .AddFeatureFlags(options.features)
       .Add("<filename>", "input wasm file", [&](string_view arg) {
         if (filename.empty()) {
@@ -95,8 +97,8 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Sequential);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
@@ -107,7 +109,7 @@ int Main(span<const string_view> args) {
         fs::path(filename).replace_extension(".wat").string();
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data{optfile->span()};
   Tool tool{filename, data, options};
   return tool.Run();
 }
@@ -118,7 +120,8 @@ Tool::Tool(string_view filename, SpanU8 data, Options options)
 int Tool::Run() {
   BinaryErrors errors{data};
   binary::ReadCtx read_context{options.features, errors};
-  auto binary_module = binary::ReadModule(data, read_context);
+  auto binary_module = binary::ReadModule(
+      data, read_context, binary::CodeFormat::Packed, options.jobs);
   if (errors.HasError()) {
     errors.PrintTo(std::cerr);
     return 1;
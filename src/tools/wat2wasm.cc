@@ -59,6 +59,7 @@ using absl::Format;
 struct Options {
   Features features;
   bool validate = true;
+  int jobs = 1;
   std::string output_filename;
 };
 
@@ -86,6 +87,7 @@ int Main(span<const string_view> args) {
            [&](string_view arg) { options.output_filename = arg; })
       .Add("--no-validate", "Don't validate before writing",
            [&]() { options.validate = false; })
+      .AddJobsFlag(options.jobs, "parse module fields on <count> threads")
       .AddFeatureFlags(options.features)
       .Add("<filename>", "input wasm file", [&](string_view arg) {
         if (filename.empty()) {
@@ -101,8 +103,8 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Sequential);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
@@ -113,7 +115,7 @@ int Main(span<const string_view> args) {
         fs::path(filename).replace_extension(".wasm").string();
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data{optfile->span()};
   Tool tool{filename, data, options};
   return tool.Run();
 }
@@ -126,7 +128,8 @@ int Tool::Run() {
   tools::TextErrors errors{filename, data};
   text::ReadCtx read_context{options.features, errors};
   auto text_module =
-      ReadSingleModule(tokenizer, read_context).value_or(text::Module{});
+      ReadSingleModuleParallel(tokenizer, read_context, options.jobs)
+          .value_or(text::Module{});
   Expect(tokenizer, read_context, text::TokenType::Eof);
 
   Resolve(text_module, errors);
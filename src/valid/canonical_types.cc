@@ -0,0 +1,220 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/canonical_types.h"
+
+#include <cassert>
+
+#include "wasp/valid/types.h"
+
+namespace wasp::valid {
+
+namespace {
+
+// The shape of a defined type, i.e. its structure with each reference to a
+// defined type replaced by a placeholder. The referenced type indexes are
+// stored separately, in order.
+struct Shape {
+  explicit Shape(Index type_count) : type_count{type_count} {}
+
+  // Each part of the encoding starts with a tag, and lists start with their
+  // size, so two shapes are equal only if the types have the same structure.
+  enum Tag : u32 {
+    kFunction,
+    kStruct,
+    kArray,
+    kNumeric,
+    kRef,
+    kRtt,
+    kHeapKind,
+    kTypeIndex,
+    kInvalidTypeIndex,
+    kPacked,
+  };
+
+  void Push(Tag tag, u32 value) {
+    tokens.push_back(tag);
+    tokens.push_back(value);
+  }
+
+  void Add(const binary::HeapType&);
+  void Add(const binary::ReferenceType&);
+  void Add(const binary::Rtt&);
+  void Add(const binary::ValueType&);
+  void Add(const binary::ValueTypeList&);
+  void Add(const binary::StorageType&);
+  void Add(const binary::FieldType&);
+  void Add(const binary::DefinedType&);
+
+  Index type_count;
+  std::vector<u32> tokens;
+  std::vector<Index> refs;
+};
+
+void Shape::Add(const binary::HeapType& value) {
+  if (value.is_heap_kind()) {
+    Push(kHeapKind, u32(value.heap_kind().value()));
+  } else if (value.index().value() < type_count) {
+    tokens.push_back(kTypeIndex);
+    refs.push_back(value.index());
+  } else {
+    // An invalid index is only the same as itself.
+    Push(kInvalidTypeIndex, value.index().value());
+  }
+}
+
+void Shape::Add(const binary::ReferenceType& value) {
+  binary::ReferenceType canon = Canonicalize(value);
+  assert(canon.is_ref());
+  Push(kRef, u32(canon.ref()->null));
+  Add(canon.ref()->heap_type);
+}
+
+void Shape::Add(const binary::Rtt& value) {
+  Push(kRtt, value.depth.value());
+  Add(value.type);
+}
+
+void Shape::Add(const binary::ValueType& value) {
+  if (value.is_numeric_type()) {
+    Push(kNumeric, u32(value.numeric_type().value()));
+  } else if (value.is_reference_type()) {
+    Add(value.reference_type());
+  } else {
+    assert(value.is_rtt());
+    Add(value.rtt());
+  }
+}
+
+void Shape::Add(const binary::ValueTypeList& value) {
+  tokens.push_back(value.size());
+  for (const auto& value_type : value) {
+    Add(value_type);
+  }
+}
+
+void Shape::Add(const binary::StorageType& value) {
+  if (value.is_value_type()) {
+    Add(value.value_type());
+  } else {
+    Push(kPacked, u32(value.packed_type().value()));
+  }
+}
+
+void Shape::Add(const binary::FieldType& value) {
+  tokens.push_back(u32(value.mut.value()));
+  Add(value.type);
+}
+
+void Shape::Add(const binary::DefinedType& value) {
+  if (value.is_function_type()) {
+    tokens.push_back(kFunction);
+    Add(value.function_type()->param_types);
+    Add(value.function_type()->result_types);
+  } else if (value.is_struct_type()) {
+    const auto& fields = value.struct_type()->fields;
+    Push(kStruct, u32(fields.size()));
+    for (const auto& field : fields) {
+      Add(field);
+    }
+  } else {
+    assert(value.is_array_type());
+    tokens.push_back(kArray);
+    Add(value.array_type()->field);
+  }
+}
+
+}  // namespace
+
+void CanonicalTypes::Reset() {
+  ids_.clear();
+  match_.clear();
+  assumed_match_.clear();
+}
+
+void CanonicalTypes::Update(const std::vector<binary::DefinedType>& types) {
+  if (ids_.size() == types.size()) {
+    return;
+  }
+
+  Index type_count = types.size();
+  std::vector<Shape> shapes;
+  shapes.reserve(type_count);
+  for (const auto& type : types) {
+    shapes.emplace_back(type_count);
+    shapes.back().Add(type);
+  }
+
+  // Group the types by shape.
+  std::vector<Index> ids(type_count);
+  Index group_count;
+  {
+    flat_hash_map<std::vector<u32>, Index> groups;
+    for (Index i = 0; i < type_count; ++i) {
+      ids[i] = groups.emplace(shapes[i].tokens, groups.size()).first->second;
+    }
+    group_count = groups.size();
+  }
+
+  // Split each group by the groups of the types it references, until no
+  // group is split.
+  std::vector<Index> new_ids(type_count);
+  std::vector<u32> key;
+  while (true) {
+    flat_hash_map<std::vector<u32>, Index> groups;
+    for (Index i = 0; i < type_count; ++i) {
+      key.assign(1, ids[i]);
+      for (Index ref : shapes[i].refs) {
+        key.push_back(ids[ref]);
+      }
+      new_ids[i] = groups.emplace(key, groups.size()).first->second;
+    }
+    if (groups.size() == group_count) {
+      break;
+    }
+    group_count = groups.size();
+    ids.swap(new_ids);
+  }
+
+  ids_ = std::move(ids);
+  match_.clear();
+  assumed_match_.clear();
+}
+
+auto CanonicalTypes::GetMatch(Index expected, Index actual) const
+    -> optional<bool> {
+  auto iter = match_.find(Pair{expected, actual});
+  if (iter != match_.end()) {
+    return iter->second;
+  }
+  if (assumed_match_.contains(Pair{expected, actual})) {
+    return true;
+  }
+  return nullopt;
+}
+
+void CanonicalTypes::AssumeMatch(Index expected, Index actual) {
+  assumed_match_.insert(Pair{expected, actual});
+}
+
+void CanonicalTypes::ResolveMatch(Index expected, Index actual, bool is_match) {
+  assumed_match_.erase(Pair{expected, actual});
+  if (!is_match || assumed_match_.empty()) {
+    match_.emplace(Pair{expected, actual}, is_match);
+  }
+}
+
+}  // namespace wasp::valid
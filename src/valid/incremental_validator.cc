@@ -0,0 +1,208 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/incremental_validator.h"
+
+#include <utility>
+
+#include "wasp/base/hash.h"
+#include "wasp/base/span.h"
+#include "wasp/valid/validate.h"
+
+namespace wasp::valid {
+
+namespace {
+
+std::size_t HashBytes(std::size_t seed, SpanU8 bytes) {
+  return absl::Hash<std::pair<std::size_t, string_view>>{}(
+      std::make_pair(seed, ToStringView(bytes)));
+}
+
+template <typename T>
+std::size_t HashSection(std::size_t seed, const std::vector<At<T>>& values) {
+  std::size_t hash = HashBytes(seed, {});
+  for (auto& value : values) {
+    hash = HashBytes(hash, value.loc());
+  }
+  return hash;
+}
+
+template <typename T>
+std::size_t HashSection(std::size_t seed, const optional<At<T>>& value) {
+  return value ? HashBytes(seed, value->loc()) : HashBytes(~seed, {});
+}
+
+template <typename T>
+bool ValidateSection(ValidCtx& ctx, const std::vector<T>& values) {
+  bool valid = true;
+  for (auto& value : values) {
+    valid &= Validate(ctx, value);
+  }
+  return valid;
+}
+
+template <typename T>
+bool ValidateSection(ValidCtx& ctx, const optional<T>& value) {
+  return value ? Validate(ctx, *value) : true;
+}
+
+// Validates `section`, recording the functions it declares in `declared`.
+template <typename T>
+bool ValidateSection(ValidCtx& ctx,
+                     const T& section,
+                     std::set<Index>& declared) {
+  auto previous = std::move(ctx.declared_functions);
+  ctx.declared_functions.clear();
+  bool valid = ValidateSection(ctx, section);
+  declared = ctx.declared_functions;
+  ctx.declared_functions.insert(previous.begin(), previous.end());
+  return valid;
+}
+
+template <typename T>
+bool ValidateCodes(ValidCtx& ctx,
+                   const std::vector<T>& codes,
+                   const std::vector<std::size_t>* previous_hashes,
+                   std::vector<std::size_t>& hashes,
+                   Index& validated_count) {
+  bool valid = true;
+  for (auto& code : codes) {
+    Index index = static_cast<Index>(hashes.size());
+    std::size_t hash = HashBytes(0, code.loc());
+    hashes.push_back(hash);
+    if (!previous_hashes || index >= previous_hashes->size() ||
+        (*previous_hashes)[index] != hash) {
+      ctx.code_count = index;
+      valid &= Validate(ctx, code);
+      validated_count++;
+    }
+  }
+  return valid;
+}
+
+}  // namespace
+
+IncrementalValidator::Snapshot::Snapshot(ValidCtx declarations)
+    : declarations{std::move(declarations)} {}
+
+IncrementalValidator::IncrementalValidator(const Features& features)
+    : features{features} {}
+
+bool IncrementalValidator::Validate(const binary::Module& module,
+                                    Errors& errors) {
+  std::size_t declarations_hash = 0;
+  declarations_hash = HashSection(declarations_hash, module.types);
+  declarations_hash = HashSection(declarations_hash, module.imports);
+  declarations_hash = HashSection(declarations_hash, module.functions);
+  declarations_hash = HashSection(declarations_hash, module.tables);
+  declarations_hash = HashSection(declarations_hash, module.memories);
+  declarations_hash = HashSection(declarations_hash, module.globals);
+  declarations_hash = HashSection(declarations_hash, module.events);
+
+  was_full_run =
+      !snapshot_ || snapshot_->declarations_hash != declarations_hash;
+  validated_code_count = 0;
+  if (was_full_run) {
+    snapshot_.reset();
+  }
+  const Snapshot* prev = snapshot_ ? &*snapshot_ : nullptr;
+
+  bool valid = true;
+  ValidCtx ctx{features, errors};
+  if (prev) {
+    ctx = ValidCtx{prev->declarations, errors};
+  } else {
+    valid &= BeginTypeSection(ctx, static_cast<Index>(module.types.size()));
+    valid &= ValidateSection(ctx, module.types);
+    valid &= ValidateSection(ctx, module.imports);
+    valid &= ValidateSection(ctx, module.functions);
+    valid &= ValidateSection(ctx, module.tables);
+    valid &= ValidateSection(ctx, module.memories);
+    valid &= ValidateSection(ctx, module.globals);
+    valid &= ValidateSection(ctx, module.events);
+  }
+
+  Snapshot next{prev ? std::move(snapshot_->declarations) : ctx};
+  next.declarations_hash = declarations_hash;
+  next.exports_hash = HashSection(0, module.exports);
+  next.start_hash = HashSection(0, module.start);
+  next.element_segments_hash = HashSection(0, module.element_segments);
+  next.data_count_hash = HashSection(0, module.data_count);
+  next.data_segments_hash = HashSection(0, module.data_segments);
+
+  if (!prev || prev->exports_hash != next.exports_hash) {
+    valid &= ValidateSection(ctx, module.exports,
+                             next.export_declared_functions);
+    ctx.export_names.clear();
+  } else {
+    next.export_declared_functions = prev->export_declared_functions;
+    ctx.declared_functions.insert(next.export_declared_functions.begin(),
+                                  next.export_declared_functions.end());
+  }
+
+  if (!prev || prev->start_hash != next.start_hash) {
+    valid &= ValidateSection(ctx, module.start);
+  }
+
+  if (!prev || prev->element_segments_hash != next.element_segments_hash) {
+    valid &= ValidateSection(ctx, module.element_segments,
+                             next.element_declared_functions);
+  } else {
+    next.element_declared_functions = prev->element_declared_functions;
+    ctx.declared_functions.insert(next.element_declared_functions.begin(),
+                                  next.element_declared_functions.end());
+    ctx.element_segments = prev->element_segments;
+  }
+  next.element_segments = ctx.element_segments;
+
+  if (!prev || prev->data_count_hash != next.data_count_hash) {
+    valid &= ValidateSection(ctx, module.data_count);
+  } else {
+    ctx.declared_data_count = prev->declared_data_count;
+  }
+  next.declared_data_count = ctx.declared_data_count;
+  next.declared_functions = ctx.declared_functions;
+
+  // The code entries depend on these too, so if any of them changed, all
+  // the code entries must be validated again.
+  const std::vector<std::size_t>* code_hashes = nullptr;
+  if (prev && prev->declared_functions == next.declared_functions &&
+      prev->element_segments == next.element_segments &&
+      prev->declared_data_count == next.declared_data_count) {
+    code_hashes = &prev->code_hashes;
+  }
+  valid &= ValidateCodes(ctx, module.codes, code_hashes, next.code_hashes,
+                         validated_code_count);
+  valid &= ValidateCodes(ctx, module.packed_codes, code_hashes,
+                         next.code_hashes, validated_code_count);
+
+  if (!prev || prev->data_segments_hash != next.data_segments_hash) {
+    valid &= ValidateSection(ctx, module.data_segments);
+  }
+
+  if (valid) {
+    snapshot_ = std::move(next);
+  } else {
+    snapshot_.reset();
+  }
+  return valid;
+}
+
+void IncrementalValidator::Reset() {
+  snapshot_.reset();
+}
+
+}  // namespace wasp::valid
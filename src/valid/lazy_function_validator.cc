@@ -0,0 +1,113 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/lazy_function_validator.h"
+
+#include <utility>
+
+#include "wasp/base/buffered_errors.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/valid/validate.h"
+
+namespace wasp::valid {
+
+LazyFunctionValidator::LazyFunctionValidator(const ValidCtx& ctx,
+                                             binary::CodeIndex code_index)
+    : ctx_{ctx, errors_nop_},
+      code_index_{std::move(code_index)},
+      once_flags_(code_index_.size()),
+      results_(code_index_.size()) {
+  // The copies of ctx_ are used concurrently, so they must not share the
+  // caller's side table or function stats.
+  ctx_.side_table = nullptr;
+  ctx_.code_start = nullptr;
+  ctx_.function_stats = nullptr;
+  // Compute the canonical type IDs once, before they are copied.
+  ctx_.canonical_types.Update(ctx_.types);
+}
+
+bool LazyFunctionValidator::ValidateFunction(Index func_index,
+                                             Errors& errors) {
+  if (func_index < code_index_.imported_function_count()) {
+    return true;
+  }
+  if (!code_index_.has_function(func_index)) {
+    return false;
+  }
+  Index index = func_index - code_index_.imported_function_count();
+  std::call_once(once_flags_[index], [&]() {
+    bool valid = DoValidateFunction(func_index, errors);
+    results_[index].store(valid ? kValid : kInvalid,
+                          std::memory_order_release);
+  });
+  return results_[index].load(std::memory_order_acquire) == kValid;
+}
+
+auto LazyFunctionValidator::GetResult(Index func_index) const
+    -> optional<bool> {
+  if (func_index < code_index_.imported_function_count()) {
+    return true;
+  }
+  if (!code_index_.has_function(func_index)) {
+    return nullopt;
+  }
+  Index index = func_index - code_index_.imported_function_count();
+  switch (results_[index].load(std::memory_order_acquire)) {
+    case kValid: return true;
+    case kInvalid: return false;
+    default: return nullopt;
+  }
+}
+
+auto LazyFunctionValidator::code_index() const -> const binary::CodeIndex& {
+  return code_index_;
+}
+
+bool LazyFunctionValidator::DoValidateFunction(Index func_index,
+                                               Errors& errors) {
+  std::unique_ptr<ValidCtx> code_ctx;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (!free_ctxs_.empty()) {
+      code_ctx = std::move(free_ctxs_.back());
+      free_ctxs_.pop_back();
+    }
+  }
+  // Errors are buffered, then reported while holding the lock, so several
+  // threads may share one Errors object.
+  BufferedErrors code_errors{errors.has_context()};
+  if (!code_ctx) {
+    code_ctx = std::make_unique<ValidCtx>(ctx_, code_errors);
+  }
+  code_ctx->errors = &code_errors;
+  code_ctx->code_count = func_index - code_index_.imported_function_count();
+
+  binary::ReadCtx read_ctx{ctx_.features, code_errors};
+  read_ctx.declared_data_count = ctx_.declared_data_count;
+
+  auto code = code_index_.GetCode(func_index, read_ctx);
+  bool valid = code.has_value() && ValidateCode(*code_ctx, *code, read_ctx);
+  // Errors from reading the body also make it invalid.
+  valid &= !code_errors.HasError();
+
+  code_ctx->errors = &errors_nop_;
+  std::lock_guard<std::mutex> lock{mutex_};
+  code_errors.ReplayInto(errors);
+  free_ctxs_.push_back(std::move(code_ctx));
+  return valid;
+}
+
+}  // namespace wasp::valid
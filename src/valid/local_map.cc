@@ -22,7 +22,8 @@
 
 namespace wasp::valid {
 
-LocalMap::LocalMap() {
+LocalMap::LocalMap(Index max_dense_count)
+    : max_dense_count_{max_dense_count} {
   Reset();
 }
 
@@ -30,13 +31,29 @@ void LocalMap::Reset() {
   pairs_.clear();
   let_stack_.clear();
   let_stack_.push_back(0);
+  dense_.clear();
 }
 
 auto LocalMap::GetCount() const -> Index {
   return pairs_.empty() ? 0 : pairs_.back().second;
 }
 
-auto LocalMap::GetType(Index index) const -> optional<binary::ValueType>{
+auto LocalMap::GetType(Index index) const -> optional<binary::ValueType> {
+  auto stack_type = GetStackType(index);
+  if (!stack_type) {
+    return nullopt;
+  }
+  return stack_type->value_type();
+}
+
+auto LocalMap::GetStackType(Index index) const -> optional<StackType> {
+  if (IsDense()) {
+    if (index >= dense_.size()) {
+      return nullopt;
+    }
+    return dense_[index];
+  }
+
   struct Compare {
     bool operator()(const Pair& lhs, Index rhs) { return lhs.second < rhs; }
     bool operator()(Index lhs, const Pair& rhs) { return lhs < rhs.second; }
@@ -50,7 +67,7 @@ auto LocalMap::GetType(Index index) const -> optional<binary::ValueType>{
   return iter->first;
 }
 
-bool LocalMap::Append(Index count, binary::ValueType value_type) {
+bool LocalMap::Append(Index count, StackType stack_type) {
   if (count == 0) {
     return true;
   }
@@ -77,37 +94,46 @@ bool LocalMap::Append(Index count, binary::ValueType value_type) {
 
   assert(!let_stack_.empty());
   Index insert_at = let_stack_.back();
+  Index dense_insert_at = insert_at > 0 ? pairs_[insert_at - 1].second : 0;
+  bool was_dense = IsDense();
 
   if (insert_at > 0) {
     // There's a previous value, see if we can combine this value type.
     auto& prev_pair = pairs_[insert_at - 1];
-    if (prev_pair.first == value_type) {
+    if (prev_pair.first == stack_type) {
       prev_pair.second += count;
     } else {
       pairs_.emplace(pairs_.begin() + insert_at,
-                     Pair{value_type, prev_pair.second + count});
+                     Pair{stack_type, prev_pair.second + count});
       let_stack_.back()++;
     }
   } else {
     // Inserting at the beginning, so we know that the previous count is 0.
-    pairs_.emplace(pairs_.begin(), Pair{value_type, count});
+    pairs_.emplace(pairs_.begin(), Pair{stack_type, count});
     let_stack_.back()++;
   }
 
   AdjustPartialSums(pairs_.begin() + let_stack_.back(), count);
+
+  if (IsDense()) {
+    assert(was_dense);
+    dense_.insert(dense_.begin() + dense_insert_at, count, stack_type);
+  } else if (was_dense) {
+    dense_.clear();
+  }
   return true;
 }
 
-bool LocalMap::Append(const binary::ValueTypeList& value_types) {
-  if (value_types.empty()) {
+bool LocalMap::Append(StackTypeSpan stack_types) {
+  if (stack_types.empty()) {
     return true;
   }
-  if (!CanAppend(static_cast<Index>(value_types.size()))) {
+  if (!CanAppend(static_cast<Index>(stack_types.size()))) {
     return false;
   }
 
-  for (auto value_type : value_types) {
-    bool ok = Append(1, value_type);
+  for (auto stack_type : stack_types) {
+    bool ok = Append(1, stack_type);
     assert(ok);  // Checked above, so it should always be true.
   }
   return true;
@@ -117,6 +143,10 @@ bool LocalMap::CanAppend(Index count) const {
   return GetCount() <= std::numeric_limits<Index>::max() - count;
 }
 
+bool LocalMap::IsDense() const {
+  return GetCount() <= max_dense_count_;
+}
+
 void LocalMap::AdjustPartialSums(Pairs::iterator first, Index count) {
   for (auto iter = first; iter != pairs_.end(); ++iter) {
     // Wrap-around is OK here, since the adjustment may be positive or negative.
@@ -136,6 +166,7 @@ void LocalMap::Pop() {
   if (pair_count > 0) {
     assert(pair_count - 1 < pairs_.size());
     Index var_count = pairs_[pair_count - 1].second;
+    bool was_dense = IsDense();
 
     // Erase all pairs corresponding to this let block.
     pairs_.erase(pairs_.begin(), pairs_.begin() + pair_count);
@@ -143,6 +174,22 @@ void LocalMap::Pop() {
     // Adjust the partial sums to remove the number of variables from this let
     // block.
     AdjustPartialSums(pairs_.begin(), -var_count);
+
+    if (was_dense) {
+      dense_.erase(dense_.begin(), dense_.begin() + var_count);
+    } else if (IsDense()) {
+      RebuildDense();
+    }
+  }
+}
+
+void LocalMap::RebuildDense() {
+  assert(IsDense());
+  dense_.clear();
+  Index first = 0;
+  for (const auto& pair : pairs_) {
+    dense_.insert(dense_.end(), pair.second - first, pair.first);
+    first = pair.second;
   }
 }
 
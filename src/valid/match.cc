@@ -17,6 +17,7 @@
 #include "wasp/valid/match.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "wasp/valid/valid_ctx.h"
 
@@ -29,6 +30,20 @@ auto CanonicalizeToRefType(const binary::ReferenceType& type)
   return canon.ref();
 }
 
+namespace {
+
+static_assert(sizeof(StackType) == sizeof(u64),
+              "StackType must be packed for IsIdentical");
+
+bool IsIdentical(StackTypeSpan expected, StackTypeSpan actual) {
+  assert(expected.size() == actual.size());
+  return expected.empty() ||
+         std::memcmp(expected.data(), actual.data(),
+                     expected.size() * sizeof(StackType)) == 0;
+}
+
+}  // namespace
+
 /// IsSame ///
 
 bool IsSame(ValidCtx& ctx,
@@ -43,17 +58,11 @@ bool IsSame(ValidCtx& ctx,
       return true;
     }
 
-    auto is_same_opt = ctx.same_types.Get(expected_index, actual_index);
-    if (is_same_opt) {
-      return *is_same_opt;
-    }
-
-    // Assume that they are the same and check that everything still is valid.
-    ctx.same_types.Assume(expected_index, actual_index);
-    bool is_same =
-        IsSame(ctx, ctx.types[expected_index], ctx.types[actual_index]);
-    ctx.same_types.Resolve(expected_index, actual_index, is_same);
-    return is_same;
+    // Equivalent types have the same canonical ID.
+    auto& canon = ctx.canonical_types;
+    canon.Update(ctx.types);
+    return canon.IsValid(expected_index) && canon.IsValid(actual_index) &&
+           canon.Get(expected_index) == canon.Get(actual_index);
   }
   return false;
 }
@@ -120,9 +129,15 @@ bool IsSame(ValidCtx& ctx,
 
 bool IsSame(ValidCtx& ctx, const StackType& expected, const StackType& actual) {
   // One of the types is "any" (i.e. universal supertype or subtype), or the
-  // value types are the same.
-  return expected.is_any() || actual.is_any() ||
-         IsSame(ctx, expected.value_type(), actual.value_type());
+  // value types are the same. Numeric types are only the same as themselves,
+  // so they never need to be decoded.
+  if (expected.bits == actual.bits || expected.is_any() || actual.is_any()) {
+    return true;
+  }
+  if (expected.is_numeric_type() || actual.is_numeric_type()) {
+    return false;
+  }
+  return IsSame(ctx, expected.value_type(), actual.value_type());
 }
 
 bool IsSame(ValidCtx& ctx, StackTypeSpan expected, StackTypeSpan actual) {
@@ -130,6 +145,11 @@ bool IsSame(ValidCtx& ctx, StackTypeSpan expected, StackTypeSpan actual) {
     return false;
   }
 
+  // Most type stacks are identical, so compare them all at once first.
+  if (IsIdentical(expected, actual)) {
+    return true;
+  }
+
   for (auto eiter = expected.begin(), lend = expected.end(),
             aiter = actual.begin();
        eiter != lend; ++eiter, ++aiter) {
@@ -233,19 +253,30 @@ bool IsMatch(ValidCtx& ctx,
       return true;
     }
 
-    // Check whether heap types match, but make sure to handle recursive
-    // structures. This is the same logic used in IsSame(HeapType, HeapType).
+    auto& canon = ctx.canonical_types;
+    canon.Update(ctx.types);
+    if (!(canon.IsValid(expected_index) && canon.IsValid(actual_index))) {
+      return false;
+    }
 
-    auto is_match_opt = ctx.match_types.Get(expected_index, actual_index);
+    Index expected_id = canon.Get(expected_index);
+    Index actual_id = canon.Get(actual_index);
+    if (expected_id == actual_id) {
+      return true;
+    }
+
+    // Check whether heap types match, but make sure to handle recursive
+    // structures.
+    auto is_match_opt = canon.GetMatch(expected_id, actual_id);
     if (is_match_opt) {
       return *is_match_opt;
     }
 
     // Assume that they match and check that everything still is valid.
-    ctx.match_types.Assume(expected_index, actual_index);
+    canon.AssumeMatch(expected_id, actual_id);
     bool is_match =
         IsMatch(ctx, ctx.types[expected_index], ctx.types[actual_index]);
-    ctx.match_types.Resolve(expected_index, actual_index, is_match);
+    canon.ResolveMatch(expected_id, actual_id, is_match);
     return is_match;
   }
 
@@ -315,9 +346,15 @@ bool IsMatch(ValidCtx& ctx,
              const StackType& expected,
              const StackType& actual) {
   // One of the types is "any" (i.e. universal supertype or subtype), or the
-  // value types match.
-  return expected.is_any() || actual.is_any() ||
-         IsMatch(ctx, expected.value_type(), actual.value_type());
+  // value types match. Numeric types only match themselves, so they never
+  // need to be decoded.
+  if (expected.bits == actual.bits || expected.is_any() || actual.is_any()) {
+    return true;
+  }
+  if (expected.is_numeric_type() || actual.is_numeric_type()) {
+    return false;
+  }
+  return IsMatch(ctx, expected.value_type(), actual.value_type());
 }
 
 bool IsMatch(ValidCtx& ctx, StackTypeSpan expected, StackTypeSpan actual) {
@@ -325,6 +362,11 @@ bool IsMatch(ValidCtx& ctx, StackTypeSpan expected, StackTypeSpan actual) {
     return false;
   }
 
+  // Most type stacks are identical, so compare them all at once first.
+  if (IsIdentical(expected, actual)) {
+    return true;
+  }
+
   for (auto eiter = expected.begin(), lend = expected.end(),
             aiter = actual.begin();
        eiter != lend; ++eiter, ++aiter) {
@@ -0,0 +1,43 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/side_table.h"
+
+#include <algorithm>
+
+namespace wasp::valid {
+
+void SideTable::Clear() {
+  entries.clear();
+}
+
+auto SideTable::Find(u32 offset) const -> span<const SideTableEntry> {
+  struct Compare {
+    bool operator()(const SideTableEntry& lhs, u32 rhs) {
+      return lhs.offset < rhs;
+    }
+    bool operator()(u32 lhs, const SideTableEntry& rhs) {
+      return lhs < rhs.offset;
+    }
+  };
+
+  auto [first, last] =
+      std::equal_range(entries.begin(), entries.end(), offset, Compare{});
+  return span<const SideTableEntry>{entries.data() + (first - entries.begin()),
+                                    static_cast<size_t>(last - first)};
+}
+
+}  // namespace wasp::valid
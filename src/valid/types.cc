@@ -17,18 +17,102 @@
 #include "wasp/valid/types.h"
 
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "wasp/base/hash.h"
+#include "wasp/base/hashmap.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/operator_eq_ne_macros.h"
 
 namespace wasp::valid {
 
-StackType::StackType() : type{Any{}} {}
+namespace {
 
-StackType::StackType(binary::ValueType type) : type{type} {}
+using Kind = StackType::Kind;
 
-StackType::StackType(Any type) : type{type} {}
+constexpr u64 kNullBit = 1 << 3;
+constexpr u64 kDeepRttBit = 1 << 3;  // Only for Kind::Rtt, never nullable.
+constexpr u64 kIndexBit = 1 << 4;
+constexpr int kDepthShift = 5;
+constexpr u64 kDepthMask = StackType::kMaxRttDepth;
+constexpr int kValueShift = 32;
+
+u64 Encode(Kind kind, u64 value) {
+  return u64(kind) | (value << kValueShift);
+}
+
+u64 Encode(Kind kind, const binary::HeapType& heap_type, Null null) {
+  u64 bits = null == Null::Yes ? kNullBit : 0;
+  if (heap_type.is_index()) {
+    return bits | kIndexBit | Encode(kind, heap_type.index().value());
+  } else {
+    return bits | Encode(kind, u64(heap_type.heap_kind().value()));
+  }
+}
+
+u64 Encode(const binary::ValueType& type, DeepRttTable* deep_rtts) {
+  if (type.is_numeric_type()) {
+    return Encode(Kind::Numeric, u64(type.numeric_type().value()));
+  } else if (type.is_reference_type()) {
+    const auto& reference_type = type.reference_type().value();
+    if (reference_type.is_reference_kind()) {
+      return Encode(Kind::ReferenceKind,
+                    u64(reference_type.reference_kind().value()));
+    } else {
+      const auto& ref = reference_type.ref().value();
+      return Encode(Kind::Ref, ref.heap_type.value(), ref.null);
+    }
+  } else {
+    assert(type.is_rtt());
+    const auto& rtt = type.rtt().value();
+    u64 heap_type_bits = Encode(Kind::Rtt, rtt.type.value(), Null::No);
+    if (rtt.depth.value() > StackType::kMaxRttDepth) {
+      assert(deep_rtts != nullptr);
+      auto* entry = deep_rtts->Add(rtt.depth.value(), heap_type_bits);
+      return reinterpret_cast<uintptr_t>(entry) | kDeepRttBit | u64(Kind::Rtt);
+    }
+    return (u64(rtt.depth.value()) << kDepthShift) | heap_type_bits;
+  }
+}
+
+auto DecodeHeapType(u64 bits) -> binary::HeapType {
+  u32 value = bits >> kValueShift;
+  if (bits & kIndexBit) {
+    return binary::HeapType{At<Index>{value}};
+  } else {
+    return binary::HeapType{At<HeapKind>{HeapKind(value)}};
+  }
+}
+
+auto DecodeDeepRtt(u64 bits) -> const DeepRttTable::Entry& {
+  return *reinterpret_cast<const DeepRttTable::Entry*>(
+      static_cast<uintptr_t>(bits & ~u64{alignof(DeepRttTable::Entry) - 1}));
+}
+
+}  // namespace
+
+auto DeepRttTable::Add(Index depth, u64 heap_type_bits) -> const Entry* {
+  auto [iter, inserted] =
+      entries_by_rtt_.try_emplace(std::pair{depth, heap_type_bits}, nullptr);
+  if (inserted) {
+    entries_.push_back(
+        std::make_shared<const Entry>(Entry{depth, heap_type_bits}));
+    iter->second = entries_.back().get();
+  }
+  return iter->second;
+}
+
+StackType::StackType() : bits{u64(Kind::Any)} {}
+
+StackType::StackType(binary::ValueType type) : bits{Encode(type, nullptr)} {}
+
+StackType::StackType(binary::ValueType type, DeepRttTable& deep_rtts)
+    : bits{Encode(type, &deep_rtts)} {}
+
+StackType::StackType(Any) : bits{u64(Kind::Any)} {}
 
 // static
 StackType StackType::I32() {
@@ -85,20 +169,34 @@ StackType StackType::Exnref() {
   return StackType{binary::ValueType::Exnref_NoLocation()};
 }
 
-bool StackType::is_value_type() const {
-  return holds_alternative<binary::ValueType>(type);
-}
-
-bool StackType::is_any() const {
-  return holds_alternative<Any>(type);
-}
-
-auto StackType::value_type() -> binary::ValueType& {
-  return get<binary::ValueType>(type);
-}
-
-auto StackType::value_type() const -> const binary::ValueType& {
-  return get<binary::ValueType>(type);
+auto StackType::value_type() const -> binary::ValueType {
+  u32 value = bits >> kValueShift;
+  switch (kind()) {
+    case Kind::Numeric:
+      return binary::ValueType{At<NumericType>{NumericType(value)}};
+
+    case Kind::ReferenceKind:
+      return binary::ValueType{binary::ReferenceType{
+          At<ReferenceKind>{ReferenceKind(value)}}};
+
+    case Kind::Ref:
+      return binary::ValueType{binary::ReferenceType{binary::RefType{
+          DecodeHeapType(bits), bits & kNullBit ? Null::Yes : Null::No}}};
+
+    case Kind::Rtt:
+      if (bits & kDeepRttBit) {
+        const auto& entry = DecodeDeepRtt(bits);
+        return binary::ValueType{
+            binary::Rtt{entry.depth, DecodeHeapType(entry.heap_type_bits)}};
+      }
+      return binary::ValueType{
+          binary::Rtt{Index((bits >> kDepthShift) & kDepthMask),
+                      DecodeHeapType(bits)}};
+
+    case Kind::Any:
+      break;
+  }
+  WASP_UNREACHABLE();
 }
 
 auto ToValueType(binary::StorageType type) -> binary::ValueType {
@@ -119,52 +217,54 @@ auto ToValueType(binary::HeapType type) -> binary::ValueType {
       binary::ReferenceType{binary::RefType{type, Null::Yes}}};
 }
 
-auto ToStackType(binary::StorageType type) -> StackType {
-  return StackType(ToValueType(type));
+auto ToStackType(binary::StorageType type, DeepRttTable& deep_rtts)
+    -> StackType {
+  return StackType(ToValueType(type), deep_rtts);
 }
 
-auto ToStackType(binary::ValueType type) -> StackType {
-  return StackType(type);
+auto ToStackType(binary::ValueType type, DeepRttTable& deep_rtts)
+    -> StackType {
+  return StackType(type, deep_rtts);
 }
 
 auto ToStackType(binary::ReferenceType type) -> StackType {
-  return ToStackType(ToValueType(type));
+  return StackType(ToValueType(type));
 }
 
 auto ToStackType(binary::RefType type) -> StackType {
-  return ToStackType(ToValueType(type));
+  return StackType(ToValueType(type));
 }
 
 auto ToStackType(binary::HeapType type) -> StackType {
-  return ToStackType(ToValueType(type));
+  return StackType(ToValueType(type));
 }
 
-auto ToStackTypeList(const binary::ValueTypeList& value_types)
-    -> StackTypeList {
+auto ToStackTypeList(const binary::ValueTypeList& value_types,
+                     DeepRttTable& deep_rtts) -> StackTypeList {
   StackTypeList result;
   for (auto value_type : value_types) {
-    result.push_back(StackType{*value_type});
+    result.push_back(StackType{*value_type, deep_rtts});
   }
   return result;
 }
 
-auto ToStackTypeList(const binary::LocalsList& locals_list) -> StackTypeList {
+auto ToStackTypeList(const binary::LocalsList& locals_list,
+                     DeepRttTable& deep_rtts) -> StackTypeList {
   StackTypeList result;
   for (auto& locals : locals_list) {
     for (size_t i = 0; i < locals->count; ++i) {
-      result.push_back(StackType{*locals->type});
+      result.push_back(StackType{*locals->type, deep_rtts});
     }
   }
   return result;
 }
 
 bool IsReferenceTypeOrAny(StackType type) {
-  return type.is_any() ||
-         (type.is_value_type() && type.value_type().is_reference_type());
+  return type.is_any() || type.is_reference_type();
 }
 
 bool IsRttOrAny(StackType type) {
-  return type.is_any() || (type.is_value_type() && type.value_type().is_rtt());
+  return type.is_any() || type.is_rtt();
 }
 
 auto Canonicalize(binary::ReferenceType type) -> binary::ReferenceType {
@@ -227,8 +327,7 @@ bool IsNullableType(binary::ValueType type) {
 }
 
 bool IsNullableType(StackType type) {
-  return type.is_any() ||
-         (type.is_value_type() && IsNullableType(type.value_type()));
+  return type.is_any() || type.is_reference_type();
 }
 
 auto AsNonNullableType(binary::RefType type) -> binary::RefType {
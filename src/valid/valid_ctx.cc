@@ -25,10 +25,12 @@ Label::Label(LabelType label_type,
              StackTypeSpan result_types,
              Index type_stack_limit)
     : label_type{label_type},
-      param_types{param_types.begin(), param_types.end()},
-      result_types{result_types.begin(), result_types.end()},
+      param_types{param_types},
+      result_types{result_types},
       type_stack_limit{type_stack_limit},
-      unreachable{false} {}
+      unreachable{false},
+      side_table_target{kNoSideTableEntry},
+      side_table_if{kNoSideTableEntry} {}
 
 ValidCtx::ValidCtx(Errors& errors) : errors{&errors} {}
 
@@ -61,52 +63,30 @@ bool ValidCtx::IsArrayType(Index index) const {
   return index < types.size() && types[index].is_array_type();
 }
 
-void TypeRelationSet::Reset(Index size) {
-  disjoint_set_.Reset(size);
-  assume_.clear();
-}
-
-auto TypeRelationSet::Get(Index expected, Index actual) -> optional<bool> {
-  MaybeSwapIndexes(expected, actual);
-  if (!(disjoint_set_.IsValid(expected) && disjoint_set_.IsValid(actual))) {
-    // If the indexes are invalid, then there's no point in checking whether
-    // they're equal.
-    return false;
+auto ValidCtx::GetFunctionSignature(Index index) -> const StackTypeSignature& {
+  assert(IsFunctionType(index));
+  if (index >= function_signatures.size()) {
+    function_signatures.resize(types.size());
   }
-
-  if (disjoint_set_.IsSameSet(expected, actual)) {
-    return true;
+  auto& signature = function_signatures[index];
+  if (!signature) {
+    const auto& function_type = types[index].function_type();
+    signature = StackTypeSignature{
+        ToStackTypeList(function_type->param_types, deep_rtts),
+        ToStackTypeList(function_type->result_types, deep_rtts)};
   }
-
-  auto iter = assume_.find({expected, actual});
-  if (iter == assume_.end()) {
-    return nullopt;
-  }
-
-  return iter->second;
+  return *signature;
 }
 
-void TypeRelationSet::Assume(Index expected, Index actual) {
-  MaybeSwapIndexes(expected, actual);
-  assume_.insert({{expected, actual}, true});
-}
-
-void TypeRelationSet::Resolve(Index expected, Index actual, bool is_same) {
-  MaybeSwapIndexes(expected, actual);
-  auto iter = assume_.find({expected, actual});
-  assert(iter != assume_.end());
-  if (is_same) {
-    disjoint_set_.MergeSets(expected, actual);
-    assume_.erase(iter);
-  } else {
-    iter->second = false;
-  }
-}
-
-void TypeRelationSet::MaybeSwapIndexes(Index& lhs, Index& rhs) {
-  if (lhs > rhs) {
-    std::swap(lhs, rhs);
+auto ValidCtx::GetBlockSignature(StackType result)
+    -> const StackTypeSignature& {
+  // Entries may move when the map grows, but their StackTypeLists keep the
+  // same storage, so previously returned spans are unaffected.
+  auto [iter, inserted] = block_signatures.try_emplace(result);
+  if (inserted) {
+    iter->second.result_types.push_back(result);
   }
+  return iter->second;
 }
 
 }  // namespace wasp::valid
@@ -26,6 +26,8 @@
 #include "wasp/base/types.h"
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
 #include "wasp/valid/match.h"
 #include "wasp/valid/valid_ctx.h"
 
@@ -33,8 +35,8 @@ namespace wasp::valid {
 
 bool BeginTypeSection(ValidCtx& ctx, Index type_count) {
   ctx.defined_type_count = type_count;
-  ctx.same_types.Reset(type_count);
-  ctx.match_types.Reset(type_count);
+  ctx.canonical_types.Reset();
+  ctx.function_signatures.clear();
   return true;
 }
 
@@ -51,6 +53,13 @@ bool BeginCode(ValidCtx& ctx, Location loc) {
   ctx.type_stack.clear();
   ctx.label_stack.clear();
   ctx.locals.Reset();
+  ctx.code_start = loc.data();
+  if (ctx.side_table) {
+    ctx.side_table->Clear();
+  }
+  if (ctx.function_stats) {
+    *ctx.function_stats = FunctionStats{};
+  }
   // Don't validate the index, should have already been validated at this point.
   if (function.type_index < ctx.defined_type_count) {
     const auto& defined_type = ctx.types[function.type_index];
@@ -60,11 +69,11 @@ bool BeginCode(ValidCtx& ctx, Location loc) {
     }
 
     assert(defined_type.is_function_type());
-    const auto& function_type = defined_type.function_type();
-    ctx.locals.Append(function_type->param_types);
-    ctx.label_stack.push_back(
-        Label{LabelType::Function, ToStackTypeList(function_type->param_types),
-              ToStackTypeList(function_type->result_types), 0});
+    const auto& signature = ctx.GetFunctionSignature(function.type_index);
+    ctx.locals.Append(signature.param_types);
+    ctx.label_stack.push_back(Label{LabelType::Function,
+                                    signature.param_types,
+                                    signature.result_types, 0});
     return true;
   } else {
     // Not valid, but try to continue anyway.
@@ -73,6 +82,22 @@ bool BeginCode(ValidCtx& ctx, Location loc) {
   }
 }
 
+bool ValidateCode(ValidCtx& ctx,
+                  const At<binary::Code>& code,
+                  binary::ReadCtx& read_ctx) {
+  if (!(BeginCode(ctx, code.loc()) &&
+        Validate(ctx, code->locals, RequireDefaultable::Yes))) {
+    return false;
+  }
+  for (auto&& instr : binary::ReadExpression(*code->body, read_ctx)) {
+    if (!Validate(ctx, instr)) {
+      return false;
+    }
+  }
+  binary::EndCode(code->body->data.last(0), read_ctx);
+  return true;
+}
+
 bool CheckDefaultable(ValidCtx& ctx,
                       const At<binary::ReferenceType>& value,
                       string_view desc) {
@@ -122,6 +147,22 @@ bool Validate(ValidCtx& ctx, const At<binary::UnpackedCode>& value) {
   return valid;
 }
 
+bool Validate(ValidCtx& ctx, const binary::PackedExpression& value) {
+  bool valid = true;
+  for (Index i = 0; i < value.size(); ++i) {
+    valid &= Validate(ctx, value[i]);
+  }
+  return valid;
+}
+
+bool Validate(ValidCtx& ctx, const At<binary::PackedCode>& value) {
+  bool valid = true;
+  valid &= BeginCode(ctx, value.loc());
+  valid &= Validate(ctx, value->locals, RequireDefaultable::Yes);
+  valid &= Validate(ctx, value->body);
+  return valid;
+}
+
 bool Validate(ValidCtx& ctx, const At<binary::ArrayType>& value) {
   ErrorsContextGuard guard{*ctx.errors, value.loc(), "array type"};
   return Validate(ctx, value->field);
@@ -143,13 +184,17 @@ bool Validate(ValidCtx& ctx,
   new_context.type_stack.clear();
   new_context.label_stack.clear();
   new_context.locals.Reset();
+  new_context.side_table = nullptr;
+  new_context.function_stats = nullptr;
 
   // Validate as if this expression was a function that takes no parameters,
   // and returns the expected type.
   new_context.label_stack.push_back(
       Label{LabelType::Function,
             {},
-            ToStackTypeList(binary::ValueTypeList{expected_type}),
+            new_context.GetBlockSignature(
+                StackType{expected_type, new_context.deep_rtts})
+                .result_types,
             0});
 
   for (auto&& instruction : value->instructions) {
@@ -776,6 +821,7 @@ bool Validate(ValidCtx& ctx, const binary::Module& value) {
   valid &= ValidateKnownSection(ctx, value.element_segments);
   valid &= ValidateKnownSection(ctx, value.data_count);
   valid &= ValidateKnownSection(ctx, value.codes);
+  valid &= ValidateKnownSection(ctx, value.packed_codes);
   valid &= ValidateKnownSection(ctx, value.data_segments);
   return valid;
 }
@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -84,6 +85,19 @@ optional<FunctionType> GetFunctionType(ValidCtx& ctx, At<Index> index) {
   return ctx.types[index].function_type();
 }
 
+const StackTypeSignature* GetFunctionSignature(ValidCtx& ctx,
+                                               At<Index> index) {
+  if (!ValidateIndex(ctx, index, static_cast<Index>(ctx.types.size()),
+                     "type index")) {
+    return nullptr;
+  }
+  if (!ctx.types[index].is_function_type()) {
+    ctx.errors->OnError(index.loc(), "Expected a function type");
+    return nullptr;
+  }
+  return &ctx.GetFunctionSignature(index);
+}
+
 optional<StructType> GetStructType(ValidCtx& ctx, At<Index> index) {
   if (!ValidateIndex(ctx, index, static_cast<Index>(ctx.types.size()),
                      "type index")) {
@@ -160,19 +174,24 @@ optional<PackedType> GetStructFieldPackedType(ValidCtx& ctx,
   return GetFieldPackedType(ctx, loc, *field_type);
 }
 
-optional<FunctionType> GetBlockTypeSignature(ValidCtx& ctx,
-                                             BlockType block_type) {
+const StackTypeSignature& VoidSignature() {
+  static const StackTypeSignature void_signature;
+  return void_signature;
+}
+
+const StackTypeSignature* GetBlockTypeSignature(ValidCtx& ctx,
+                                                BlockType block_type) {
   if (block_type.is_void()) {
-    return FunctionType{};
+    return &VoidSignature();
   } else if (block_type.is_value_type()) {
     const auto& value_type = block_type.value_type();
     if (!Validate(ctx, value_type)) {
-      return nullopt;
+      return nullptr;
     }
-    return FunctionType{{}, {value_type}};
+    return &ctx.GetBlockSignature(StackType{value_type, ctx.deep_rtts});
   } else {
     assert(block_type.is_index());
-    return GetFunctionType(ctx, block_type.index());
+    return GetFunctionSignature(ctx, block_type.index());
   }
 }
 
@@ -238,11 +257,7 @@ optional<StackType> GetLocalType(ValidCtx& ctx, At<Index> index) {
   if (!ValidateIndex(ctx, index, ctx.locals.GetCount(), "local index")) {
     return nullopt;
   }
-  auto local_type = ctx.locals.GetType(index);
-  if (!local_type) {
-    return nullopt;
-  }
-  return StackType(*local_type);
+  return ctx.locals.GetStackType(index);
 }
 
 bool CheckDataSegment(ValidCtx& ctx, At<Index> index) {
@@ -258,10 +273,6 @@ Function MaybeDefault(optional<Function> value) {
   return value.value_or(Function{0});
 }
 
-FunctionType MaybeDefault(optional<FunctionType> value) {
-  return value.value_or(FunctionType{});
-}
-
 TableType MaybeDefault(optional<TableType> value) {
   return value.value_or(
       TableType{Limits{0}, ReferenceType::Funcref_NoLocation()});
@@ -280,6 +291,10 @@ ReferenceType MaybeDefault(optional<ReferenceType> value) {
   return value.value_or(ReferenceType::Externref_NoLocation());
 }
 
+const StackTypeSignature& MaybeDefault(const StackTypeSignature* value) {
+  return value ? *value : VoidSignature();
+}
+
 Label MaybeDefault(const Label* value) {
   return value ? *value : Label{LabelType::Block, {}, {}, 0};
 }
@@ -332,12 +347,9 @@ bool CheckTypes(ValidCtx& ctx, Location loc, StackTypeSpan expected) {
 
 Label* GetFunctionLabel(ValidCtx&);
 
-bool CheckResultTypes(ValidCtx& ctx,
-                      Location loc,
-                      const FunctionType& function_type) {
+bool CheckResultTypes(ValidCtx& ctx, Location loc, StackTypeSpan caller) {
   auto* label = GetFunctionLabel(ctx);
   assert(label != nullptr);
-  auto caller = ToStackTypeList(function_type.result_types);
   auto callee = label->br_types();
 
   if (!IsMatch(ctx, callee, caller)) {
@@ -438,12 +450,12 @@ auto PopTypedReference(ValidCtx& ctx, Location loc)
 }
 
 auto PopFunctionReference(ValidCtx& ctx, Location loc)
-    -> std::pair<optional<StackType>, std::optional<FunctionType>> {
+    -> std::pair<optional<StackType>, const StackTypeSignature*> {
   auto [stack_type, index] = PopTypedReference(ctx, loc);
   if (stack_type && !stack_type->is_any() && index) {
-    return {stack_type, GetFunctionType(ctx, *index)};
+    return {stack_type, GetFunctionSignature(ctx, *index)};
   } else {
-    return {stack_type, nullopt};
+    return {stack_type, nullptr};
   }
 }
 
@@ -490,9 +502,9 @@ bool PopAndPushTypes(ValidCtx& ctx,
 
 bool PopAndPushTypes(ValidCtx& ctx,
                      Location loc,
-                     const FunctionType& function_type) {
-  return PopAndPushTypes(ctx, loc, ToStackTypeList(function_type.param_types),
-                         ToStackTypeList(function_type.result_types));
+                     const StackTypeSignature& signature) {
+  return PopAndPushTypes(ctx, loc, signature.param_types,
+                         signature.result_types);
 }
 
 void SetUnreachable(ValidCtx& ctx) {
@@ -515,17 +527,130 @@ Label* GetFunctionLabel(ValidCtx& ctx) {
   return GetLabel(ctx, static_cast<Index>(ctx.label_stack.size() - 1));
 }
 
+u32 GetCodeOffset(ValidCtx& ctx, const u8* ptr) {
+  return static_cast<u32>(ptr - ctx.code_start);
+}
+
+// Records a branch from the instruction at `loc` to `label`. The target of a
+// forward branch isn't known yet, so the entry is added to the label's list
+// instead, and filled in by EndSideTableLabel.
+void AddSideTableBranch(ValidCtx& ctx, Location loc, Label& label) {
+  if (!ctx.side_table) {
+    return;
+  }
+  auto& entries = ctx.side_table->entries;
+  auto value_count = static_cast<u32>(label.br_types().size());
+  auto height =
+      static_cast<u32>(ctx.type_stack.size() - label.type_stack_limit);
+  // In unreachable code, the stack may hold fewer values than the label.
+  u32 drop_count = height > value_count ? height - value_count : 0;
+  entries.push_back(SideTableEntry{GetCodeOffset(ctx, loc.data()),
+                                   label.side_table_target, value_count,
+                                   drop_count});
+  if (label.label_type != LabelType::Loop) {
+    label.side_table_target = static_cast<u32>(entries.size() - 1);
+  }
+}
+
+void BeginSideTableLabel(ValidCtx& ctx, Location loc, Label& label) {
+  assert(ctx.side_table);
+  if (label.label_type == LabelType::Loop) {
+    label.side_table_target = GetCodeOffset(ctx, loc.end());
+  } else if (label.label_type == LabelType::If) {
+    // The false branch keeps the params for the `else` arm.
+    auto& entries = ctx.side_table->entries;
+    label.side_table_if = static_cast<Index>(entries.size());
+    entries.push_back(SideTableEntry{
+        GetCodeOffset(ctx, loc.data()), kNoSideTableEntry,
+        static_cast<u32>(label.param_types.size()), 0});
+  }
+}
+
+// Called for `else` and `catch`, which end the previous arm with a branch to
+// the label's `end`.
+void AddSideTableElse(ValidCtx& ctx, Location loc) {
+  if (!ctx.side_table) {
+    return;
+  }
+  auto& label = TopLabel(ctx);
+  if (label.label_type == LabelType::If) {
+    AddSideTableBranch(ctx, loc, label);
+    ctx.side_table->entries[label.side_table_if].target_offset =
+        GetCodeOffset(ctx, loc.end());
+    label.side_table_if = kNoSideTableEntry;
+  } else if (label.label_type == LabelType::Try) {
+    AddSideTableBranch(ctx, loc, label);
+  }
+}
+
+void EndSideTableLabel(ValidCtx& ctx, Location loc, Label& label) {
+  assert(ctx.side_table);
+  auto& entries = ctx.side_table->entries;
+  u32 target = GetCodeOffset(ctx, loc.end());
+  if (label.side_table_if != kNoSideTableEntry) {
+    entries[label.side_table_if].target_offset = target;
+  }
+  if (label.label_type != LabelType::Loop) {
+    for (Index index = label.side_table_target; index != kNoSideTableEntry;) {
+      Index next = entries[index].target_offset;
+      entries[index].target_offset = target;
+      index = next;
+    }
+  }
+}
+
+// Called before each instruction is validated. The stack height and label
+// depth after an instruction are seen before the next one, and the last
+// instruction (the function's `end`) never increases them, so this finds
+// their maximums.
+void UpdateFunctionStats(ValidCtx& ctx, const Instruction& instruction) {
+  auto& stats = *ctx.function_stats;
+  stats.instruction_count++;
+  stats.local_count = std::max(stats.local_count, ctx.locals.GetCount());
+  stats.max_stack_height = std::max(
+      stats.max_stack_height, static_cast<Index>(ctx.type_stack.size()));
+  stats.max_label_depth = std::max(
+      stats.max_label_depth, static_cast<Index>(ctx.label_stack.size() - 1));
+
+  switch (instruction.opcode) {
+    case Opcode::LocalGet:
+      stats.local_reads++;
+      break;
+
+    case Opcode::LocalSet:
+    case Opcode::LocalTee:
+      stats.local_writes++;
+      break;
+
+    case Opcode::Call:
+    case Opcode::CallIndirect:
+    case Opcode::CallRef:
+    case Opcode::ReturnCall:
+    case Opcode::ReturnCallIndirect:
+    case Opcode::ReturnCallRef:
+      stats.calls++;
+      break;
+
+    default:
+      if (instruction.has_mem_arg_immediate()) {
+        stats.memory_accesses++;
+      }
+      break;
+  }
+}
+
 bool PushLabel(ValidCtx& ctx,
                Location loc,
                LabelType label_type,
-               const FunctionType& type) {
-  auto stack_param_types = ToStackTypeList(type.param_types);
-  auto stack_result_types = ToStackTypeList(type.result_types);
-  bool valid = PopTypes(ctx, loc, stack_param_types);
-  ctx.label_stack.emplace_back(label_type, stack_param_types,
-                               stack_result_types,
+               const StackTypeSignature& signature) {
+  bool valid = PopTypes(ctx, loc, signature.param_types);
+  ctx.label_stack.emplace_back(label_type, signature.param_types,
+                               signature.result_types,
                                static_cast<Index>(ctx.type_stack.size()));
-  PushTypes(ctx, stack_param_types);
+  if (ctx.side_table) {
+    BeginSideTableLabel(ctx, loc, ctx.label_stack.back());
+  }
+  PushTypes(ctx, signature.param_types);
   return valid;
 }
 
@@ -583,6 +708,9 @@ bool Else(ValidCtx& ctx, Location loc) {
 bool End(ValidCtx& ctx, Location loc) {
   auto& top_label = TopLabel(ctx);
   bool valid = true;
+  if (ctx.side_table) {
+    EndSideTableLabel(ctx, loc, top_label);
+  }
   if (top_label.label_type == LabelType::If) {
     valid &= Else(ctx, loc);
   } else if (top_label.label_type == LabelType::Let) {
@@ -597,7 +725,10 @@ bool End(ValidCtx& ctx, Location loc) {
 }
 
 bool Br(ValidCtx& ctx, Location loc, At<Index> depth) {
-  const auto* label = GetLabel(ctx, depth);
+  auto* label = GetLabel(ctx, depth);
+  if (label) {
+    AddSideTableBranch(ctx, loc, *label);
+  }
   bool valid = PopTypes(ctx, loc, MaybeDefault(label).br_types());
   SetUnreachable(ctx);
   return AllTrue(label, valid);
@@ -605,7 +736,10 @@ bool Br(ValidCtx& ctx, Location loc, At<Index> depth) {
 
 bool BrIf(ValidCtx& ctx, Location loc, At<Index> depth) {
   bool valid = PopType(ctx, loc, StackType::I32());
-  const auto* label = GetLabel(ctx, depth);
+  auto* label = GetLabel(ctx, depth);
+  if (label) {
+    AddSideTableBranch(ctx, loc, *label);
+  }
   auto label_ = MaybeDefault(label);
   return AllTrue(
       valid, label,
@@ -616,7 +750,7 @@ bool BrTable(ValidCtx& ctx,
              Location loc,
              const At<BrTableImmediate>& immediate) {
   bool valid = PopType(ctx, loc, StackType::I32());
-  const auto* default_label = GetLabel(ctx, immediate->default_target);
+  auto* default_label = GetLabel(ctx, immediate->default_target);
   if (!default_label) {
     return false;
   }
@@ -625,8 +759,9 @@ bool BrTable(ValidCtx& ctx,
   valid &= CheckTypes(ctx, immediate->default_target.loc(), br_types);
 
   for (auto target : immediate->targets) {
-    const auto* label = GetLabel(ctx, target);
+    auto* label = GetLabel(ctx, target);
     if (label) {
+      AddSideTableBranch(ctx, loc, *label);
       if (ctx.features.function_references_enabled()) {
         if (br_types.size() != label->br_types().size()) {
           ctx.errors->OnError(
@@ -649,25 +784,27 @@ bool BrTable(ValidCtx& ctx,
       valid = false;
     }
   }
+  AddSideTableBranch(ctx, loc, *default_label);
   SetUnreachable(ctx);
   return valid;
 }
 
 bool Call(ValidCtx& ctx, Location loc, At<Index> function_index) {
   auto function = GetFunction(ctx, function_index);
-  auto function_type = GetFunctionType(ctx, MaybeDefault(function).type_index);
-  return AllTrue(function, function_type,
-                 PopAndPushTypes(ctx, loc, MaybeDefault(function_type)));
+  auto* signature =
+      GetFunctionSignature(ctx, MaybeDefault(function).type_index);
+  return AllTrue(function, signature,
+                 PopAndPushTypes(ctx, loc, MaybeDefault(signature)));
 }
 
 bool CallIndirect(ValidCtx& ctx,
                   Location loc,
                   const At<CallIndirectImmediate>& immediate) {
   auto table_type = GetTableType(ctx, immediate->table_index);
-  auto function_type = GetFunctionType(ctx, immediate->index);
+  auto* signature = GetFunctionSignature(ctx, immediate->index);
   bool valid = PopType(ctx, loc, StackType::I32());
-  return AllTrue(table_type, function_type, valid,
-                 PopAndPushTypes(ctx, loc, MaybeDefault(function_type)));
+  return AllTrue(table_type, signature, valid,
+                 PopAndPushTypes(ctx, loc, MaybeDefault(signature)));
 }
 
 bool Select(ValidCtx& ctx, Location loc) {
@@ -698,8 +835,7 @@ bool SelectT(ValidCtx& ctx,
     return false;
   }
   valid &= Validate(ctx, value_types);
-  StackTypeList stack_types = ToStackTypeList(value_types);
-  StackType type = stack_types[0];
+  StackType type{value_types->front()};
   const StackType pop_types[] = {type, type};
   const StackType push_type[] = {type};
   return AllTrue(valid, PopAndPushTypes(ctx, loc, pop_types, push_type));
@@ -724,7 +860,8 @@ bool LocalTee(ValidCtx& ctx, Location loc, At<Index> index) {
 
 bool GlobalGet(ValidCtx& ctx, At<Index> index) {
   auto global_type = GetGlobalType(ctx, index);
-  PushType(ctx, StackType(*MaybeDefault(global_type).valtype));
+  PushType(ctx,
+           StackType(*MaybeDefault(global_type).valtype, ctx.deep_rtts));
   return AllTrue(global_type);
 }
 
@@ -738,7 +875,8 @@ bool GlobalSet(ValidCtx& ctx, Location loc, At<Index> index) {
         concat("global.set is invalid on immutable global ", index));
     valid = false;
   }
-  return AllTrue(valid, PopType(ctx, loc, StackType(*type.valtype)));
+  return AllTrue(valid,
+                 PopType(ctx, loc, StackType(*type.valtype, ctx.deep_rtts)));
 }
 
 bool TableGet(ValidCtx& ctx, Location loc, At<Index> index) {
@@ -1138,35 +1276,35 @@ bool AtomicRmw(ValidCtx& ctx,
 
 bool ReturnCall(ValidCtx& ctx, Location loc, At<Index> function_index) {
   auto function = GetFunction(ctx, function_index);
-  auto function_type = GetFunctionType(ctx, MaybeDefault(function).type_index);
-  bool valid = CheckResultTypes(ctx, loc, MaybeDefault(function_type));
-  valid &= PopTypes(ctx, loc,
-                    ToStackTypeList(MaybeDefault(function_type).param_types));
+  auto* signature =
+      GetFunctionSignature(ctx, MaybeDefault(function).type_index);
+  bool valid =
+      CheckResultTypes(ctx, loc, MaybeDefault(signature).result_types);
+  valid &= PopTypes(ctx, loc, MaybeDefault(signature).param_types);
   SetUnreachable(ctx);
-  return AllTrue(function, function_type, valid);
+  return AllTrue(function, signature, valid);
 }
 
 bool ReturnCallIndirect(ValidCtx& ctx,
                         Location loc,
                         const At<CallIndirectImmediate>& immediate) {
   auto table_type = GetTableType(ctx, 0);
-  auto function_type = GetFunctionType(ctx, immediate->index);
-  bool valid = CheckResultTypes(ctx, loc, MaybeDefault(function_type));
+  auto* signature = GetFunctionSignature(ctx, immediate->index);
+  bool valid =
+      CheckResultTypes(ctx, loc, MaybeDefault(signature).result_types);
   valid &= PopType(ctx, loc, StackType::I32());
-  valid &= PopTypes(ctx, loc,
-                    ToStackTypeList(MaybeDefault(function_type).param_types));
+  valid &= PopTypes(ctx, loc, MaybeDefault(signature).param_types);
   SetUnreachable(ctx);
-  return AllTrue(table_type, function_type, valid);
+  return AllTrue(table_type, signature, valid);
 }
 
 bool Throw(ValidCtx& ctx, Location loc, At<Index> index) {
   auto event_type = GetEventType(ctx, index);
-  auto function_type =
-      GetFunctionType(ctx, MaybeDefault(event_type).type_index);
-  bool valid = PopTypes(
-      ctx, loc, ToStackTypeList(MaybeDefault(function_type).param_types));
+  auto* signature =
+      GetFunctionSignature(ctx, MaybeDefault(event_type).type_index);
+  bool valid = PopTypes(ctx, loc, MaybeDefault(signature).param_types);
   SetUnreachable(ctx);
-  return AllTrue(event_type, function_type, valid);
+  return AllTrue(event_type, signature, valid);
 }
 
 bool Rethrow(ValidCtx& ctx, Location loc) {
@@ -1179,14 +1317,13 @@ bool BrOnExn(ValidCtx& ctx,
              Location loc,
              const At<BrOnExnImmediate>& immediate) {
   auto event_type = GetEventType(ctx, immediate->event_index);
-  auto function_type =
-      GetFunctionType(ctx, MaybeDefault(event_type).type_index);
+  auto* signature =
+      GetFunctionSignature(ctx, MaybeDefault(event_type).type_index);
   auto* label = GetLabel(ctx, immediate->target);
-  bool valid =
-      IsMatch(ctx, ToStackTypeList(MaybeDefault(function_type).param_types),
-              MaybeDefault(label).br_types());
+  bool valid = IsMatch(ctx, MaybeDefault(signature).param_types,
+                       MaybeDefault(label).br_types());
   valid &= PopAndPushTypes(ctx, loc, span_exnref, span_exnref);
-  return AllTrue(event_type, function_type, label, valid);
+  return AllTrue(event_type, signature, label, valid);
 }
 
 bool BrOnNull(ValidCtx& ctx, Location loc, const At<Index>& depth) {
@@ -1222,7 +1359,7 @@ bool RefAsNonNull(ValidCtx& ctx, Location loc) {
 }
 
 bool CallRef(ValidCtx& ctx, Location loc) {
-  auto [stack_type, function_type] = PopFunctionReference(ctx, loc);
+  auto [stack_type, signature] = PopFunctionReference(ctx, loc);
   if (!stack_type) {
     return false;
   }
@@ -1230,12 +1367,12 @@ bool CallRef(ValidCtx& ctx, Location loc) {
     return true;
   }
 
-  return AllTrue(function_type,
-                 PopAndPushTypes(ctx, loc, MaybeDefault(function_type)));
+  return AllTrue(signature,
+                 PopAndPushTypes(ctx, loc, MaybeDefault(signature)));
 }
 
 bool ReturnCallRef(ValidCtx& ctx, Location loc) {
-  auto [stack_type, function_type] = PopFunctionReference(ctx, loc);
+  auto [stack_type, signature] = PopFunctionReference(ctx, loc);
   if (!stack_type) {
     return false;
   }
@@ -1243,16 +1380,16 @@ bool ReturnCallRef(ValidCtx& ctx, Location loc) {
     return true;
   }
 
-  bool valid = CheckResultTypes(ctx, loc, MaybeDefault(function_type));
-  valid &= PopTypes(ctx, loc,
-                    ToStackTypeList(MaybeDefault(function_type).param_types));
+  bool valid =
+      CheckResultTypes(ctx, loc, MaybeDefault(signature).result_types);
+  valid &= PopTypes(ctx, loc, MaybeDefault(signature).param_types);
   SetUnreachable(ctx);
-  return AllTrue(function_type, valid);
+  return AllTrue(signature, valid);
 }
 
 bool FuncBind(ValidCtx& ctx, Location loc, At<FuncBindImmediate> immediate) {
   auto new_type_index = immediate->index;
-  auto [stack_type, old_function_type] = PopFunctionReference(ctx, loc);
+  auto [stack_type, old_type_index] = PopTypedReference(ctx, loc);
   if (!stack_type) {
     return false;
   }
@@ -1263,6 +1400,10 @@ bool FuncBind(ValidCtx& ctx, Location loc, At<FuncBindImmediate> immediate) {
     return true;
   }
 
+  optional<FunctionType> old_function_type;
+  if (old_type_index) {
+    old_function_type = GetFunctionType(ctx, *old_type_index);
+  }
   auto new_function_type = GetFunctionType(ctx, new_type_index);
   if (!old_function_type || !new_function_type) {
     return false;
@@ -1310,12 +1451,14 @@ bool FuncBind(ValidCtx& ctx, Location loc, At<FuncBindImmediate> immediate) {
   StackTypeList stack_results{
       ToStackType(RefType{HeapType{new_type_index}, Null::No})};
 
-  return AllTrue(valid, PopAndPushTypes(ctx, loc, ToStackTypeList(bound_params),
-                                        stack_results));
+  StackTypeList stack_params = ToStackTypeList(bound_params, ctx.deep_rtts);
+  return AllTrue(valid,
+                 PopAndPushTypes(ctx, loc, stack_params, stack_results));
 }
 
 bool Let(ValidCtx& ctx, Location loc, const At<LetImmediate>& immediate) {
-  bool valid = PopTypes(ctx, loc, ToStackTypeList(immediate->locals));
+  bool valid =
+      PopTypes(ctx, loc, ToStackTypeList(immediate->locals, ctx.deep_rtts));
   valid &= PushLabel(ctx, loc, LabelType::Let, immediate->block_type);
   ctx.locals.Push();
   valid &= Validate(ctx, immediate->locals, RequireDefaultable::No);
@@ -1408,7 +1551,7 @@ bool SimdShuffle(ValidCtx& ctx,
 
 bool RttCanon(ValidCtx& ctx, Location loc, const At<HeapType>& immediate) {
   u32 depth = immediate->is_heap_kind(HeapKind::Any) ? 0 : 1;
-  PushType(ctx, ToStackType(ValueType{Rtt{depth, immediate}}));
+  PushType(ctx, ToStackType(ValueType{Rtt{depth, immediate}}, ctx.deep_rtts));
   return true;
 }
 
@@ -1431,7 +1574,7 @@ bool RttSub(ValidCtx& ctx, Location loc, const At<HeapType>& immediate) {
         loc, concat(new_rtt.type, " is not a subtype of ", old_rtt->type));
     return false;
   }
-  PushType(ctx, ToStackType(ValueType{new_rtt}));
+  PushType(ctx, ToStackType(ValueType{new_rtt}, ctx.deep_rtts));
   return true;
 }
 
@@ -1530,7 +1673,7 @@ bool StructNewWithRtt(ValidCtx& ctx, Location loc, const At<Index>& immediate) {
     if (struct_type) {
       StackTypeList stack_types;
       for (auto& field : struct_type->fields) {
-        stack_types.push_back(ToStackType(field->type));
+        stack_types.push_back(ToStackType(field->type, ctx.deep_rtts));
       }
       valid &= PopTypes(ctx, loc, stack_types);
     }
@@ -1581,7 +1724,7 @@ bool StructGet(ValidCtx& ctx,
     return false;
   }
 
-  PushType(ctx, StackType{*value_type});
+  PushType(ctx, StackType{*value_type, ctx.deep_rtts});
   return true;
 }
 
@@ -1626,7 +1769,7 @@ bool StructSet(ValidCtx& ctx,
 
   StackTypeList stack_types{StackType{ValueType{ReferenceType{RefType{
                                 HeapType{immediate->struct_}, Null::Yes}}}},
-                            ToStackType(field_type->type)};
+                            ToStackType(field_type->type, ctx.deep_rtts)};
   return AllTrue(valid, PopTypes(ctx, loc, stack_types));
 }
 
@@ -1642,8 +1785,9 @@ bool ArrayNewWithRtt(ValidCtx& ctx, Location loc, const At<Index>& immediate) {
 
     auto array_type = GetArrayType(ctx, immediate);
     if (array_type) {
-      StackTypeList stack_types{ToStackType(array_type->field->type),
-                                StackType::I32()};
+      StackTypeList stack_types{
+          ToStackType(array_type->field->type, ctx.deep_rtts),
+          StackType::I32()};
       valid &= PopTypes(ctx, loc, stack_types);
     }
   }
@@ -1689,7 +1833,7 @@ bool ArrayGet(ValidCtx& ctx, Location loc, const At<Index>& immediate) {
     return false;
   }
 
-  PushType(ctx, StackType{*value_type});
+  PushType(ctx, StackType{*value_type, ctx.deep_rtts});
   return valid;
 }
 
@@ -1726,7 +1870,7 @@ bool ArraySet(ValidCtx& ctx, Location loc, const At<Index>& immediate) {
       StackType{
           ValueType{ReferenceType{RefType{HeapType{immediate}, Null::Yes}}}},
       StackType::I32(),
-      ToStackType(array_type->field->type),
+      ToStackType(array_type->field->type, ctx.deep_rtts),
   };
   return AllTrue(valid, PopTypes(ctx, loc, stack_types));
 }
@@ -1754,7 +1898,8 @@ bool Validate(ValidCtx& ctx,
   }
   valid &= Validate(ctx, value->type);
 
-  if (!ctx.locals.Append(value->count, value->type)) {
+  if (!ctx.locals.Append(value->count,
+                         StackType{value->type, ctx.deep_rtts})) {
     const Index max = std::numeric_limits<Index>::max();
     ctx.errors->OnError(
         value.loc(),
@@ -1783,6 +1928,10 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
     return false;
   }
 
+  if (ctx.function_stats) {
+    UpdateFunctionStats(ctx, *value);
+  }
+
   Location loc = value.loc();
 
   StackTypeSpan params, results;
@@ -1810,6 +1959,7 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
     }
 
     case Opcode::Else:
+      AddSideTableElse(ctx, loc);
       return Else(ctx, loc);
 
     case Opcode::End:
@@ -1819,6 +1969,7 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
       return PushLabel(ctx, loc, LabelType::Try, value->block_type_immediate());
 
     case Opcode::Catch:
+      AddSideTableElse(ctx, loc);
       return Catch(ctx, loc);
 
     case Opcode::Throw:
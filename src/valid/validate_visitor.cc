@@ -16,12 +16,40 @@
 
 #include "wasp/valid/validate_visitor.h"
 
-#include <cassert>
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/parallel_code_section.h"
+#include "wasp/binary/read/read_ctx.h"
 
 namespace wasp::valid {
 
-ValidateVisitor::ValidateVisitor(Features features, Errors& errors)
-    : ctx{features, errors}, features{features}, errors{errors} {}
+ValidateVisitor::ValidateVisitor(Features features, Errors& errors, int jobs)
+    : ctx{features, errors}, features{features}, errors{errors}, jobs{jobs} {}
+
+auto ValidateVisitor::BeginModule(binary::LazyModule& module) -> Result {
+  this->module = &module;
+  return Result::Ok;
+}
+
+auto ValidateVisitor::OnSection(At<binary::Section> section) -> Result {
+  if (jobs > 1 && !skip_codes && module && section->is_known() &&
+      section->known()->id == binary::SectionId::Code) {
+    // The section can only be read up front if all of it is in the module's
+    // data. That isn't true for StreamDecoder, where each section arrives
+    // separately, and the code bodies may not have arrived yet. In that case
+    // the bodies are validated serially as they are visited.
+    SpanU8 data = section->known()->data;
+    if (data.begin() >= module->data.begin() &&
+        data.end() <= module->data.end()) {
+      // Validated here instead, so the Code section is skipped by the
+      // visitor.
+      return ValidateCodeSectionParallel(data);
+    }
+  }
+  return Result::Ok;
+}
 
 auto ValidateVisitor::BeginTypeSection(binary::LazyTypeSection sec) -> Result {
   return FailUnless(valid::BeginTypeSection(ctx, sec.count.value_or(0)));
@@ -71,7 +99,19 @@ auto ValidateVisitor::OnDataCount(const At<binary::DataCount>& data_count)
   return FailUnless(Validate(ctx, data_count));
 }
 
+auto ValidateVisitor::BeginCodeSection(binary::LazyCodeSection) -> Result {
+  return skip_codes ? Result::Skip : Result::Ok;
+}
+
 auto ValidateVisitor::BeginCode(const At<binary::Code>& code) -> Result {
+  if (build_side_tables) {
+    side_tables.emplace_back();
+    ctx.side_table = &side_tables.back();
+  }
+  if (collect_function_stats) {
+    function_stats.emplace_back();
+    ctx.function_stats = &function_stats.back();
+  }
   return FailUnless(valid::BeginCode(ctx, code.loc()) &&
                     Validate(ctx, code->locals, RequireDefaultable::Yes));
 }
@@ -89,4 +129,47 @@ auto ValidateVisitor::FailUnless(bool b) -> Result {
   return b ? Result::Ok : Result::Fail;
 }
 
+auto ValidateVisitor::ValidateCodeSectionParallel(SpanU8 section_data)
+    -> Result {
+  binary::ParallelCodeSection section{section_data, module->ctx};
+  const Index count = section.size();
+  const Index first_code_count = ctx.code_count;
+  std::vector<optional<ValidCtx>> worker_ctxs(jobs);
+  // Each worker copies ctx, so compute the canonical type IDs up front rather
+  // than once per worker.
+  ctx.canonical_types.Update(ctx.types);
+  if (build_side_tables) {
+    side_tables.resize(first_code_count + count);
+  }
+  if (collect_function_stats) {
+    function_stats.resize(first_code_count + count);
+  }
+
+  auto failed = section.ForEach(jobs, [&](Index index, Index worker,
+                                          const At<binary::Code>& code,
+                                          binary::ReadCtx& read_ctx) {
+    auto& worker_ctx = worker_ctxs[worker];
+    if (!worker_ctx) {
+      worker_ctx.emplace(ctx, read_ctx.errors);
+    }
+    ValidCtx& code_ctx = *worker_ctx;
+    code_ctx.errors = &read_ctx.errors;
+    code_ctx.code_count = first_code_count + index;
+    code_ctx.side_table =
+        build_side_tables ? &side_tables[first_code_count + index] : nullptr;
+    code_ctx.function_stats =
+        collect_function_stats ? &function_stats[first_code_count + index]
+                               : nullptr;
+    return ValidateCode(code_ctx, code, read_ctx);
+  });
+
+  // Serially, the visit ends at the first body that fails.
+  if (failed) {
+    ctx.code_count += *failed + 1;
+    return Result::Fail;
+  }
+  ctx.code_count += count;
+  return Result::Skip;
+}
+
 }  // namespace wasp::valid
@@ -0,0 +1,67 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/compact_location.h"
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+namespace {
+
+const u8 kData[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+}  // namespace
+
+TEST(CompactLocationTest, RoundTrip) {
+  SpanU8 base{kData};
+  Location loc = base.subspan(2, 3);
+  CompactLocation compact{base, loc};
+  EXPECT_TRUE(compact.is_valid());
+  EXPECT_EQ(2u, compact.offset);
+  EXPECT_EQ(3u, compact.size);
+  EXPECT_EQ(loc.data(), compact.ToLocation(base).data());
+  EXPECT_EQ(loc.size(), compact.ToLocation(base).size());
+}
+
+TEST(CompactLocationTest, Empty) {
+  SpanU8 base{kData};
+  CompactLocation compact{base, Location{}};
+  EXPECT_FALSE(compact.is_valid());
+  EXPECT_EQ(nullptr, compact.ToLocation(base).data());
+  EXPECT_FALSE(CompactLocation{}.is_valid());
+}
+
+TEST(CompactLocationTest, EmptyInsideBase) {
+  SpanU8 base{kData};
+  Location loc = base.subspan(5, 0);
+  CompactLocation compact{base, loc};
+  EXPECT_TRUE(compact.is_valid());
+  EXPECT_EQ(5u, compact.offset);
+  EXPECT_EQ(0u, compact.size);
+  EXPECT_EQ(loc.data(), compact.ToLocation(base).data());
+  EXPECT_EQ(0u, compact.ToLocation(base).size());
+}
+
+TEST(CompactLocationTest, OutsideBase) {
+  SpanU8 base = SpanU8{kData}.first(4);
+  CompactLocation compact{base, SpanU8{kData}.subspan(3, 2)};
+  EXPECT_FALSE(compact.is_valid());
+
+  // Resolving against a base that is too small.
+  CompactLocation past_end{6, 2};
+  EXPECT_EQ(nullptr, past_end.ToLocation(base).data());
+}
@@ -0,0 +1,144 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/file.h"
+
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace ::wasp;
+
+namespace {
+
+const char kContents[] = "\0asm\x01\0\0\0 and some more";
+
+// Write `contents` to a new file in the test's temporary directory, and
+// return its name.
+std::string WriteTempFile(const std::string& name, string_view contents) {
+  std::string filename = ::testing::TempDir() + name;
+  std::ofstream stream{filename, std::ios::out | std::ios::binary};
+  stream.write(contents.data(), contents.size());
+  return filename;
+}
+
+}  // namespace
+
+TEST(FileTest, MapFile_RegularFile) {
+  const string_view contents{kContents, sizeof(kContents) - 1};
+  auto filename = WriteTempFile("wasp_file_test_regular", contents);
+
+  for (auto access :
+       {FileAccess::Normal, FileAccess::Sequential, FileAccess::Random}) {
+    auto file = MapFile(filename, access);
+    ASSERT_TRUE(file.has_value());
+#if !defined(_WIN32)
+    EXPECT_TRUE(file->is_mapped());
+#endif
+    EXPECT_EQ(contents, ToStringView(file->span()));
+    file->Advise(FileAccess::Random);
+    EXPECT_EQ(contents, ToStringView(file->span()));
+  }
+}
+
+TEST(FileTest, MapFile_Move) {
+  const string_view contents{kContents, sizeof(kContents) - 1};
+  auto filename = WriteTempFile("wasp_file_test_move", contents);
+
+  auto file = MapFile(filename);
+  ASSERT_TRUE(file.has_value());
+  MappedFile moved{std::move(*file)};
+  EXPECT_TRUE(file->span().empty());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_EQ(contents, ToStringView(moved.span()));
+
+  MappedFile assigned;
+  assigned = std::move(moved);
+  EXPECT_TRUE(moved.span().empty());
+  EXPECT_EQ(contents, ToStringView(assigned.span()));
+}
+
+TEST(FileTest, MapFile_EmptyFile) {
+  auto filename = WriteTempFile("wasp_file_test_empty", "");
+
+  // An empty file can't be mapped, so it is read instead.
+  auto file = MapFile(filename);
+  ASSERT_TRUE(file.has_value());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_TRUE(file->span().empty());
+}
+
+TEST(FileTest, MapFile_MissingFile) {
+  EXPECT_FALSE(
+      MapFile(::testing::TempDir() + "wasp_file_test_missing").has_value());
+}
+
+#if !defined(_WIN32)
+
+namespace {
+
+// Create a pipe that holds `contents`, and return its read end.
+int MakePipe(string_view contents) {
+  int fds[2];
+  EXPECT_EQ(0, ::pipe(fds));
+  EXPECT_EQ(static_cast<ssize_t>(contents.size()),
+            ::write(fds[1], contents.data(), contents.size()));
+  ::close(fds[1]);
+  return fds[0];
+}
+
+}  // namespace
+
+TEST(FileTest, MapFile_Pipe) {
+  const string_view contents{kContents, sizeof(kContents) - 1};
+  int fd = MakePipe(contents);
+
+  // A pipe can't be mapped, so it is read instead.
+  auto file = MapFile("/dev/fd/" + std::to_string(fd));
+  ::close(fd);
+  ASSERT_TRUE(file.has_value());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_EQ(contents, ToStringView(file->span()));
+}
+
+TEST(FileTest, MapFile_Stdin) {
+  const string_view contents{kContents, sizeof(kContents) - 1};
+  int fd = MakePipe(contents);
+  int saved_stdin = ::dup(STDIN_FILENO);
+  ASSERT_LE(0, saved_stdin);
+  ASSERT_EQ(STDIN_FILENO, ::dup2(fd, STDIN_FILENO));
+  ::close(fd);
+
+  auto file = MapFile("-");
+
+  // stdin is not closed by MapFile.
+  EXPECT_EQ(STDIN_FILENO, ::dup2(saved_stdin, STDIN_FILENO));
+  ::close(saved_stdin);
+
+  ASSERT_TRUE(file.has_value());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_EQ(contents, ToStringView(file->span()));
+}
+
+#endif
@@ -0,0 +1,53 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/parallel_for.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+TEST(ParallelForTest, Serial) {
+  std::vector<Index> visited;
+  ParallelFor(5, 1, [&](Index index, Index worker) {
+    EXPECT_EQ(0u, worker);
+    visited.push_back(index);
+  });
+  EXPECT_EQ((std::vector<Index>{0, 1, 2, 3, 4}), visited);
+}
+
+TEST(ParallelForTest, Empty) {
+  int calls = 0;
+  ParallelFor(0, 4, [&](Index, Index) { ++calls; });
+  EXPECT_EQ(0, calls);
+}
+
+TEST(ParallelForTest, VisitsEachIndexOnce) {
+  const Index kCount = 1000;
+  for (int jobs : {2, 4, 16}) {
+    std::vector<std::atomic<int>> counts(kCount);
+    ParallelFor(kCount, jobs, [&](Index index, Index worker) {
+      EXPECT_LT(worker, static_cast<Index>(jobs));
+      counts[index]++;
+    });
+    for (Index i = 0; i < kCount; ++i) {
+      EXPECT_EQ(1, counts[i]) << "jobs=" << jobs << " index=" << i;
+    }
+  }
+}
@@ -0,0 +1,142 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/code_index.h"
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/sections.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+TEST(BinaryCodeIndexTest, Basic) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const SpanU8 data =
+      "\x03"                      // Count.
+      "\x02\x00\x0b"              // (func)
+      "\x04\x01\x01\x7f\x0b"      // (func (local i32))
+      "\x04\x00\x01\x01\x0b"_su8;  // (func nop)
+
+  CodeIndex index{data, ctx};
+  ExpectNoErrors(errors);
+  ASSERT_EQ(3u, index.size());
+  EXPECT_FALSE(index.empty());
+
+  EXPECT_EQ(data.subspan(1, 3), index.GetLocation(0));
+  EXPECT_EQ(data.subspan(4, 5), index.GetLocation(1));
+  EXPECT_EQ(data.subspan(9, 5), index.GetLocation(2));
+  EXPECT_EQ(data.subspan(2, 2), index.GetBody(0));
+  EXPECT_EQ(data.subspan(5, 4), index.GetBody(1));
+  EXPECT_EQ(data.subspan(10, 4), index.GetBody(2));
+  EXPECT_EQ(nullopt, index.GetLocation(3));
+  EXPECT_EQ(nullopt, index.GetBody(3));
+
+  // Each Code is the same as the one read by iterating over the section.
+  Index func_index = 0;
+  for (const auto& code : ReadCodeSection(data, ctx).sequence) {
+    EXPECT_EQ(code, index.GetCode(func_index++, ctx));
+  }
+  EXPECT_EQ(3u, func_index);
+  EXPECT_EQ(nullopt, index.GetCode(3, ctx));
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryCodeIndexTest, ImportedFunctions) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const SpanU8 data = "\x01\x02\x00\x0b"_su8;
+
+  CodeIndex index{data, ctx, 2};
+  EXPECT_EQ(2u, index.imported_function_count());
+  EXPECT_EQ(1u, index.size());
+  EXPECT_FALSE(index.has_function(0));
+  EXPECT_FALSE(index.has_function(1));
+  EXPECT_TRUE(index.has_function(2));
+  EXPECT_FALSE(index.has_function(3));
+  EXPECT_EQ(data.subspan(1, 3), index.GetLocation(2));
+  EXPECT_EQ(nullopt, index.GetLocation(0));
+}
+
+TEST(BinaryCodeIndexTest, LongSizePrefix) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const SpanU8 data = "\x01\x82\x80\x00\x00\x0b"_su8;
+
+  CodeIndex index{data, ctx};
+  ExpectNoErrors(errors);
+  EXPECT_EQ(data.subspan(1, 5), index.GetLocation(0));
+  EXPECT_EQ(data.subspan(4, 2), index.GetBody(0));
+}
+
+TEST(BinaryCodeIndexTest, CountMismatch) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const SpanU8 data = "\x01\x02\x00\x0b\x02\x00\x0b"_su8;
+
+  CodeIndex index{data, ctx};
+  EXPECT_EQ(2u, index.size());
+  ExpectError({{0, "code section"},
+               {0, "Expected code section to have count 1, got 2"}},
+              errors, data);
+}
+
+TEST(BinaryCodeIndexTest, PastEnd) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const SpanU8 data = "\x02\x02\x00\x0b\x05\x00"_su8;
+
+  CodeIndex index{data, ctx};
+  // The entries before the error are still indexed.
+  EXPECT_EQ(1u, index.size());
+  EXPECT_EQ(data.subspan(1, 3), index.GetLocation(0));
+  ExpectError({{0, "code section"}, {4, "Length extends past end: 5 > 1"}},
+              errors, data);
+}
+
+TEST(BinaryCodeIndexTest, ReadCodeIndex) {
+  TestErrors errors;
+  const SpanU8 data =
+      "\0asm\x01\0\0\0"
+      "\x01\x04\x01\x60\0\0"          // 1 type: params:[] results:[]
+      "\x02\x0b\x01\0\x06import\0\0"  // 1 import: func mod:"" name:"import"
+      "\x03\x03\x02\0\0"              // 2 funcs: type 0, type 0
+      "\x0a\x07\x02\x02\0\x0b\x02\0\x0b"_su8;  // 2 code: both empty
+  auto module = ReadLazyModule(data, Features{}, errors);
+
+  auto index = ReadCodeIndex(module);
+  ExpectNoErrors(errors);
+  EXPECT_EQ(1u, index.imported_function_count());
+  EXPECT_EQ(2u, index.size());
+  EXPECT_FALSE(index.has_function(0));
+  EXPECT_TRUE(index.has_function(1));
+  EXPECT_TRUE(index.has_function(2));
+  EXPECT_EQ(data.last(3), index.GetLocation(2));
+}
+
+TEST(BinaryCodeIndexTest, ReadCodeIndex_NoCodeSection) {
+  TestErrors errors;
+  auto module = ReadLazyModule("\0asm\x01\0\0\0"_su8, Features{}, errors);
+
+  auto index = ReadCodeIndex(module);
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(nullopt, index.GetLocation(0));
+}
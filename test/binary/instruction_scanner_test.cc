@@ -0,0 +1,195 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/instruction_scanner.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/read/read_ctx.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+namespace {
+
+// Scan `data`, and check that the scanner finds the same instructions and
+// reports the same errors as ReadExpression.
+void ExpectSameAsReadExpression(SpanU8 data, ReadCtx& ctx) {
+  TestErrors expected_errors;
+  ReadCtx expected_ctx{ctx.features, expected_errors};
+  expected_ctx.declared_data_count = ctx.declared_data_count;
+  std::vector<At<Instruction>> expected;
+  for (const auto& instr : ReadExpression(data, expected_ctx)) {
+    expected.push_back(instr);
+  }
+
+  TestErrors errors;
+  ReadCtx scan_ctx{ctx.features, errors};
+  scan_ctx.declared_data_count = ctx.declared_data_count;
+  InstructionScanner scanner{data, scan_ctx};
+  size_t count = 0;
+  while (scanner.Next()) {
+    ASSERT_LT(count, expected.size());
+    const auto& instr = expected[count++];
+    EXPECT_EQ(instr->opcode, scanner.opcode());
+    EXPECT_EQ(instr.loc(), scanner.instruction());
+    EXPECT_EQ(instr.loc().data() - data.data(), scanner.offset());
+  }
+  EXPECT_EQ(expected.size(), count);
+
+  ASSERT_EQ(expected_errors.errors.size(), errors.errors.size());
+  for (size_t i = 0; i < errors.errors.size(); ++i) {
+    const auto& expected_list = expected_errors.errors[i];
+    const auto& list = errors.errors[i];
+    ASSERT_EQ(expected_list.size(), list.size());
+    for (size_t j = 0; j < list.size(); ++j) {
+      EXPECT_EQ(expected_list[j].loc, list[j].loc);
+      EXPECT_EQ(expected_list[j].message, list[j].message);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(BinaryInstructionScannerTest, Basic) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const SpanU8 data =
+      "\x02\x40"              // block
+      "\x10\x05"              // call 5
+      "\x28\x02\xac\x02"      // i32.load align=4 offset=300
+      "\x0e\x02\x00\x01\x02"  // br_table 0 1 2
+      "\x0b"                  // end
+      "\x0b"_su8;             // end
+
+  InstructionScanner scanner{data, ctx};
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::Block, scanner.opcode());
+  EXPECT_EQ(ImmediateKind::Block, scanner.immediate_kind());
+  EXPECT_EQ(0u, scanner.offset());
+  EXPECT_EQ("\x40"_su8, scanner.immediate());
+
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::Call, scanner.opcode());
+  EXPECT_EQ(2u, scanner.offset());
+  EXPECT_EQ("\x10\x05"_su8, scanner.instruction());
+  EXPECT_EQ(5u, scanner.index_immediate());
+
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::I32Load, scanner.opcode());
+  EXPECT_EQ(4u, scanner.offset());
+  auto memarg = scanner.memarg_immediate();
+  EXPECT_EQ(2u, memarg.align_log2);
+  EXPECT_EQ(300u, memarg.offset);
+
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::BrTable, scanner.opcode());
+  EXPECT_EQ(8u, scanner.offset());
+  std::vector<Index> targets;
+  Index default_target = scanner.ForEachBrTableTarget(
+      [&](Index target) { targets.push_back(target); });
+  EXPECT_EQ((std::vector<Index>{0, 1}), targets);
+  EXPECT_EQ(2u, default_target);
+
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::End, scanner.opcode());
+  EXPECT_EQ(13u, scanner.offset());
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::End, scanner.opcode());
+  EXPECT_EQ(14u, scanner.offset());
+  EXPECT_FALSE(scanner.Next());
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryInstructionScannerTest, MaxLengthVarInt) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  InstructionScanner scanner{"\x10\xff\xff\xff\xff\x0f"_su8, ctx};
+  ASSERT_TRUE(scanner.Next());
+  EXPECT_EQ(Opcode::Call, scanner.opcode());
+  EXPECT_EQ(0xffffffffu, scanner.index_immediate());
+  EXPECT_FALSE(scanner.Next());
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryInstructionScannerTest, SameAsReadExpression) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  ctx.features.EnableAll();
+  ctx.declared_data_count = 1;
+  ExpectSameAsReadExpression(
+      "\x02\x7f"                           // block (result i32)
+      "\x41\x7f"                           // i32.const -1
+      "\x0c\x00"                           // br 0
+      "\x0b"                               // end
+      "\x04\x40\x01\x05\x01\x0b"           // if nop else nop end
+      "\x03\x40\x0b"                       // loop end
+      "\x42\x80\x80\x80\x80\x80\x80\x80"   // i64.const...
+      "\x80\x80\x00"                       // ...0
+      "\x43\x00\x00\x80\x3f"               // f32.const 1
+      "\x44\x00\x00\x00\x00\x00\x00\xf0\x3f"  // f64.const 1
+      "\xfd\x0c\x00\x01\x02\x03\x04\x05\x06\x07"  // v128.const...
+      "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"   // ...
+      "\xfd\x15\x03"                       // i8x16.extract_lane_s 3
+      "\x3f\x00"                           // memory.size
+      "\x11\x01\x00"                       // call_indirect 1 0
+      "\x1c\x01\x7f"                       // select (result i32)
+      "\xfc\x08\x00\x00"                   // memory.init 0
+      "\xfc\x09\x00"                       // data.drop 0
+      "\xfc\x0a\x00\x00"                   // memory.copy
+      "\xfc\x0c\x01\x00"                   // table.init 1 0
+      "\xfc\x0e\x00\x01"                   // table.copy 0 1
+      "\xd0\x70"                           // ref.null func
+      "\x0b"_su8,                          // end
+      ctx);
+}
+
+TEST(BinaryInstructionScannerTest, Errors) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  const std::vector<SpanU8> bodies = {
+      "\x10"_su8,                      // Missing index.
+      "\x41\x80"_su8,                  // Truncated s32.
+      "\x41\x80\x80\x80\x80\x70"_su8,  // Bad sign extension.
+      "\xff"_su8,                      // Unknown opcode.
+      "\xfc\xff\x01"_su8,              // Unknown prefixed opcode.
+      "\x3f\x01"_su8,                  // Reserved byte is not zero.
+      "\x0b\x01"_su8,                  // Instruction after final end.
+      "\x0e\x05\x00"_su8,              // br_table count past end.
+      "\x02\x50"_su8,                  // Bad block type.
+      "\xfc\x08\x00\x00"_su8,          // No data count section.
+  };
+  for (auto body : bodies) {
+    ExpectSameAsReadExpression(body, ctx);
+  }
+}
+
+TEST(BinaryInstructionScannerTest, ErrorKeepsCallerCtx) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  ctx.open_blocks.push_back(At{"\x02"_su8, Opcode::Block});
+  ctx.seen_final_end = true;
+
+  InstructionScanner scanner{"\x10"_su8, ctx};  // Missing index.
+  EXPECT_FALSE(scanner.Next());
+  EXPECT_EQ(1u, errors.errors.size());
+  EXPECT_EQ(1u, ctx.open_blocks.size());
+  EXPECT_TRUE(ctx.seen_final_end);
+}
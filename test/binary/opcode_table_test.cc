@@ -0,0 +1,95 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/read/opcode_table.h"
+
+#include "gtest/gtest.h"
+#include "wasp/binary/encoding.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+namespace {
+
+// The tables must agree with encoding::Opcode::Decode.
+void ExpectMatchesDecode(const Features& features) {
+  const OpcodeTable table{features};
+  for (int code = 0; code < 256; ++code) {
+    auto info = table.Lookup(code);
+    if (encoding::Opcode::IsPrefixByte(code, features)) {
+      EXPECT_TRUE(info.is_prefix()) << code;
+      for (u32 prefixed_code = 0; prefixed_code < 512; ++prefixed_code) {
+        auto decoded = encoding::Opcode::Decode(code, prefixed_code, features);
+        auto prefixed_info = table.Lookup(code, prefixed_code);
+        ASSERT_EQ(decoded.has_value(), prefixed_info.is_valid())
+            << code << " " << prefixed_code;
+        if (decoded) {
+          EXPECT_EQ(*decoded, prefixed_info.opcode);
+          EXPECT_EQ(GetImmediateKind(*decoded), prefixed_info.immediate_kind);
+        }
+      }
+    } else {
+      auto decoded = encoding::Opcode::Decode(code, features);
+      ASSERT_EQ(decoded.has_value(), info.is_valid()) << code;
+      if (decoded) {
+        EXPECT_EQ(*decoded, info.opcode);
+        EXPECT_EQ(GetImmediateKind(*decoded), info.immediate_kind);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(BinaryOpcodeTableTest, DefaultFeatures) {
+  ExpectMatchesDecode(Features{});
+}
+
+TEST(BinaryOpcodeTableTest, AllFeatures) {
+  Features features;
+  features.EnableAll();
+  ExpectMatchesDecode(features);
+}
+
+TEST(BinaryOpcodeTableTest, NoFeatures) {
+  ExpectMatchesDecode(Features{0});
+}
+
+TEST(BinaryOpcodeTableTest, ImmediateKind) {
+  Features features;
+  features.EnableAll();
+  const auto& table = OpcodeTable::Get(features);
+  EXPECT_EQ(ImmediateKind::None, table.Lookup(0x01).immediate_kind);
+  EXPECT_EQ(ImmediateKind::Block, table.Lookup(0x02).immediate_kind);
+  EXPECT_EQ(ImmediateKind::I32Const, table.Lookup(0x41).immediate_kind);
+  EXPECT_EQ(ImmediateKind::MemArg, table.Lookup(0x28).immediate_kind);
+  EXPECT_EQ(ImmediateKind::V128Const,
+            table.Lookup(encoding::Opcode::SimdPrefix, 0x0c).immediate_kind);
+  EXPECT_EQ(ImmediateKind::StructField,
+            table.Lookup(encoding::Opcode::GcPrefix, 0x03).immediate_kind);
+}
+
+TEST(BinaryOpcodeTableTest, Get_Cached) {
+  Features simd;
+  simd.enable_simd();
+  EXPECT_EQ(&OpcodeTable::Get(Features{}), &OpcodeTable::Get(Features{}));
+  EXPECT_NE(&OpcodeTable::Get(Features{}), &OpcodeTable::Get(simd));
+  EXPECT_TRUE(
+      OpcodeTable::Get(simd).Lookup(encoding::Opcode::SimdPrefix).is_prefix());
+  EXPECT_FALSE(OpcodeTable::Get(Features{0})
+                   .Lookup(encoding::Opcode::SimdPrefix)
+                   .is_prefix());
+}
@@ -0,0 +1,149 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/types.h"
+
+#include "gtest/gtest.h"
+#include "wasp/binary/formatters.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+namespace {
+
+// Instructions read back from a PackedExpression without a base have no
+// locations, so none of these values have locations either.
+const HeapType HT_Func{At{HeapKind::Func}};
+const HeapType HT_Any{At{HeapKind::Any}};
+const HeapType HT_Eq{At{HeapKind::Eq}};
+const HeapType HT_I31{At{HeapKind::I31}};
+const HeapType HT_0{At{Index{0}}};
+const HeapType HT_1{At{Index{1}}};
+const HeapType HT_2{At{Index{2}}};
+const ValueType VT_I32 = ValueType::I32_NoLocation();
+const ValueType VT_F32 = ValueType::F32_NoLocation();
+const ValueType VT_Externref = ValueType::Externref_NoLocation();
+const ValueType VT_RefNull0{
+    At{ReferenceType{At{RefType{At{HT_0}, Null::Yes}}}}};
+const ValueType VT_RefFunc{
+    At{ReferenceType{At{RefType{At{HT_Func}, Null::No}}}}};
+const ValueType VT_RTT_0_Any{At{Rtt{At{Index{0}}, At{HT_Any}}}};
+const BlockType BT_Void{At{VoidType{}}};
+const BlockType BT_I32{At{VT_I32}};
+const BlockType BT_RefNull0{At{VT_RefNull0}};
+const BlockType BT_RTT_0_Any{At{VT_RTT_0_Any}};
+
+}  // namespace
+
+TEST(BinaryPackedExpressionTest, Empty) {
+  PackedExpression expr;
+  EXPECT_TRUE(expr.empty());
+  EXPECT_EQ(0u, expr.size());
+  EXPECT_EQ(InstructionList{}, expr.ToInstructionList());
+}
+
+TEST(BinaryPackedExpressionTest, RoundTrip) {
+  const InstructionList instrs{
+      Instruction{Opcode::Nop},
+      Instruction{Opcode::I32Const, s32{-42}},
+      Instruction{Opcode::I64Const, s64{-0x123456789abcdef}},
+      Instruction{Opcode::F32Const, f32{1.5f}},
+      Instruction{Opcode::F64Const, f64{-2.25}},
+      Instruction{Opcode::V128Const, At{v128{u32{1}, u32{2}, u32{3}, u32{4}}}},
+      Instruction{Opcode::LocalGet, Index{0xffffffff}},
+      Instruction{Opcode::Block, At{BT_Void}},
+      Instruction{Opcode::Block, At{BT_I32}},
+      Instruction{Opcode::Block, At{BlockType{At{Index{7}}}}},
+      Instruction{Opcode::Block, At{BT_RefNull0}},
+      Instruction{Opcode::Block, At{BT_RTT_0_Any}},
+      Instruction{Opcode::BrOnExn, At{BrOnExnImmediate{Index{1}, Index{2}}}},
+      Instruction{Opcode::BrTable,
+                  At{BrTableImmediate{{Index{3}, Index{4}, Index{5}}, Index{6}}}},
+      Instruction{Opcode::BrTable, At{BrTableImmediate{{}, Index{0}}}},
+      Instruction{Opcode::CallIndirect,
+                  At{CallIndirectImmediate{Index{1}, Index{2}}}},
+      Instruction{Opcode::TableCopy, At{CopyImmediate{Index{3}, Index{4}}}},
+      Instruction{Opcode::MemoryInit, At{InitImmediate{Index{5}, Index{6}}}},
+      Instruction{Opcode::Let,
+                  At{LetImmediate{BT_Void,
+                                  {Locals{Index{2}, At{VT_I32}},
+                                   Locals{Index{1}, At{VT_Externref}}}}}},
+      Instruction{Opcode::I32Load, At{MemArgImmediate{u32{2}, u32{1024}}}},
+      Instruction{Opcode::RefNull, At{HT_Func}},
+      Instruction{Opcode::RefNull, At{HT_2}},
+      Instruction{Opcode::SelectT, At{SelectImmediate{VT_F32, VT_RefFunc}}},
+      Instruction{Opcode::I8X16Shuffle,
+                  At{ShuffleImmediate{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                      12, 13, 14, 15}}},
+      Instruction{Opcode::I8X16ExtractLaneS, SimdLaneImmediate{15}},
+      Instruction{Opcode::FuncBind, At{FuncBindImmediate{Index{9}}}},
+      Instruction{Opcode::BrOnCast,
+                  At{BrOnCastImmediate{Index{1},
+                                       HeapType2Immediate{HT_Any, HT_0}}}},
+      Instruction{Opcode::RefTest,
+                  At{HeapType2Immediate{HT_Func, HT_1}}},
+      Instruction{Opcode::RttSub,
+                  At{RttSubImmediate{Index{1},
+                                     HeapType2Immediate{HT_Eq, HT_I31}}}},
+      Instruction{Opcode::StructGet,
+                  At{StructFieldImmediate{Index{1}, Index{2}}}},
+      Instruction{Opcode::End},
+  };
+
+  PackedExpression expr{SpanU8{}, instrs};
+  ASSERT_EQ(instrs.size(), expr.size());
+  for (Index i = 0; i < expr.size(); ++i) {
+    EXPECT_EQ(instrs[i]->opcode, expr.opcode(i));
+    EXPECT_EQ(instrs[i]->kind(), expr.kind(i));
+  }
+  EXPECT_EQ(instrs, expr.ToInstructionList());
+  EXPECT_EQ(expr, (PackedExpression{SpanU8{}, expr.ToInstructionList()}));
+}
+
+TEST(BinaryPackedExpressionTest, Locations) {
+  // i32.const 42; memory.init 1 0; end
+  const SpanU8 data = "\x41\x2a\xfc\x08\x01\x00\x0b"_su8;
+  const InstructionList instrs{
+      At{data.subspan(0, 2),
+         Instruction{At{data.subspan(0, 1), Opcode::I32Const},
+                     At{data.subspan(1, 1), s32{42}}}},
+      At{data.subspan(2, 4),
+         Instruction{At{data.subspan(2, 2), Opcode::MemoryInit},
+                     At{data.subspan(4, 2),
+                        InitImmediate{At{data.subspan(4, 1), Index{1}},
+                                      At{data.subspan(5, 1), Index{0}}}}}},
+      At{data.subspan(6, 1),
+         Instruction{At{data.subspan(6, 1), Opcode::End}}},
+  };
+
+  PackedExpression expr{data, instrs};
+  EXPECT_EQ(data.subspan(0, 2), expr.loc(0));
+  EXPECT_EQ(data.subspan(2, 4), expr.loc(1));
+  EXPECT_EQ(data.subspan(6, 1), expr.loc(2));
+
+  auto instr = expr[1];
+  EXPECT_EQ(data.subspan(2, 4), instr.loc());
+  EXPECT_EQ(data.subspan(2, 2), instr->opcode.loc());
+  EXPECT_EQ(data.subspan(4, 2), instr->init_immediate().loc());
+  // Fields of an immediate share the immediate's location.
+  EXPECT_EQ(data.subspan(4, 2), instr->init_immediate()->segment_index.loc());
+  EXPECT_EQ(data.subspan(4, 2), instr->init_immediate()->dst_index.loc());
+
+  // Locations outside of the base are dropped.
+  PackedExpression other{"\x0b"_su8, instrs};
+  EXPECT_EQ(nullptr, other.loc(0).data());
+  EXPECT_EQ(expr, other);
+}
@@ -16,11 +16,15 @@
 
 #include "wasp/binary/read.h"
 
+#include <iterator>
+
 #include "gtest/gtest.h"
 #include "test/binary/constants.h"
 #include "test/binary/test_utils.h"
 #include "test/test_utils.h"
+#include "wasp/base/buffer.h"
 #include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/write.h"
 
 using namespace ::wasp;
 using namespace ::wasp::binary;
@@ -76,6 +80,8 @@ TEST_F(BinaryReadModuleTest, EmptyModule) {
           {},
           // data_segments
           {},
+          // packed_codes
+          {},
       },
       "\0asm\x01\0\0\0"_su8);
 }
@@ -119,6 +125,8 @@ TEST_F(BinaryReadModuleTest, SimpleModule) {
                           Instruction{At{"\x0b"_su8, Opcode::End}}}}}}}},
           // data_segments
           {},
+          // packed_codes
+          {},
       },
       "\0asm\x01\0\0\0"
       // type: (func (result i32))
@@ -129,6 +137,148 @@ TEST_F(BinaryReadModuleTest, SimpleModule) {
       "\x0a\x06\x01\x04\x00\x41\x2a\x0b"_su8);
 }
 
+TEST_F(BinaryReadModuleTest, SimpleModule_Packed) {
+  const SpanU8 data =
+      "\0asm\x01\0\0\0"
+      // type: (func (result i32))
+      "\x01\x05\x01\x60\x00\x01\x7f"
+      // func: (func (type 0))
+      "\x03\x02\x01\x00"
+      // code: (func (type 0) i32.const 42)
+      "\x0a\x06\x01\x04\x00\x41\x2a\x0b"_su8;
+
+  auto unpacked = ReadModule(data, ctx);
+  ASSERT_TRUE(unpacked.has_value());
+  auto packed = ReadModule(data, ctx, CodeFormat::Packed);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(packed.has_value());
+
+  EXPECT_TRUE(packed->codes.empty());
+  ASSERT_EQ(1u, packed->packed_codes.size());
+  const auto& code = packed->packed_codes[0];
+  const auto& instructions = unpacked->codes[0]->body.instructions;
+  EXPECT_EQ(unpacked->codes[0].loc(), code.loc());
+  EXPECT_EQ(instructions, code->body.ToInstructionList());
+  ASSERT_EQ(2u, code->body.size());
+  EXPECT_EQ(instructions[0].loc(), code->body.loc(0));
+  EXPECT_EQ(instructions[1].loc(), code->body.loc(1));
+}
+
+TEST_F(BinaryReadModuleTest, SimpleModule_Packed_RoundTrip) {
+  const SpanU8 data =
+      "\0asm\x01\0\0\0"
+      // type: (func (result i32))
+      "\x01\x05\x01\x60\x00\x01\x7f"
+      // func: (func (type 0))
+      "\x03\x02\x01\x00"
+      // code: (func (type 0) i32.const 42)
+      "\x0a\x06\x01\x04\x00\x41\x2a\x0b"_su8;
+
+  auto packed = ReadModule(data, ctx, CodeFormat::Packed);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(packed.has_value());
+
+  Buffer buffer;
+  Write(*packed, std::back_inserter(buffer));
+  EXPECT_EQ(data, SpanU8{buffer});
+}
+
+TEST_F(BinaryReadModuleTest, Parallel) {
+  // Enough functions that they are split across several threads.
+  const u8 kFunctionCount = 50;
+  std::vector<u8> data{0, 'a', 's', 'm', 1, 0, 0, 0};
+  // type: (func)
+  data.insert(data.end(), {1, 4, 1, 0x60, 0, 0});
+  // func: (func (type 0)) * kFunctionCount
+  data.insert(data.end(), {3, static_cast<u8>(kFunctionCount + 1)});
+  data.push_back(kFunctionCount);
+  data.insert(data.end(), kFunctionCount, 0);
+  // code: (func (type 0) i32.const N drop) * kFunctionCount
+  const Index code_size = 1 + kFunctionCount * 6;
+  data.insert(data.end(), {10, static_cast<u8>(code_size | 0x80),
+                           static_cast<u8>(code_size >> 7), kFunctionCount});
+  for (u8 i = 0; i < kFunctionCount; ++i) {
+    data.insert(data.end(), {5, 0, 0x41, i, 0x1a, 0x0b});
+  }
+
+  for (auto format : {CodeFormat::Unpacked, CodeFormat::Packed}) {
+    auto serial = ReadModule(data, ctx, format);
+    auto parallel = ReadModule(data, ctx, format, 4);
+    ExpectNoErrors(errors);
+    ASSERT_TRUE(serial.has_value());
+    ASSERT_TRUE(parallel.has_value());
+    EXPECT_EQ(*serial, *parallel);
+    if (format == CodeFormat::Unpacked) {
+      ASSERT_EQ(kFunctionCount, parallel->codes.size());
+      EXPECT_EQ(serial->codes, parallel->codes);
+    } else {
+      ASSERT_EQ(kFunctionCount, parallel->packed_codes.size());
+      for (Index i = 0; i < kFunctionCount; ++i) {
+        EXPECT_EQ(serial->packed_codes[i]->body.ToInstructionList(),
+                  parallel->packed_codes[i]->body.ToInstructionList());
+      }
+    }
+  }
+}
+
+TEST_F(BinaryReadModuleTest, Parallel_Errors) {
+  ctx.features.enable_function_references();
+
+  // More functions than fit in two batches of ParallelFor, with errors in
+  // different batches, so more than one thread is used.
+  const u8 kFunctionCount = 40;
+  std::vector<std::vector<u8>> bodies(kFunctionCount, {0, 0x0b});
+  bodies[5] = {0, 0xff};        // Unknown opcode.
+  bodies[6] = {0};              // No end.
+  bodies[20] = {0, 0x02, 0x40};  // Unclosed block.
+  // (local i32 * 0xffffffff) let (local i32) end end
+  bodies[30] = {1,    0xff, 0xff, 0xff, 0xff, 0x0f, 0x7f, 0x17,
+                0x40, 1,    1,    0x7f, 0x0b, 0x0b};
+
+  std::vector<u8> code{kFunctionCount};
+  for (Index i = 0; i < kFunctionCount - 1; ++i) {
+    code.push_back(static_cast<u8>(bodies[i].size()));
+    code.insert(code.end(), bodies[i].begin(), bodies[i].end());
+  }
+  // Length extends past end.
+  code.insert(code.end(), {5, 0});
+
+  std::vector<u8> data{0, 'a', 's', 'm', 1, 0, 0, 0};
+  // type: (func)
+  data.insert(data.end(), {1, 4, 1, 0x60, 0, 0});
+  // func: (func (type 0)) * kFunctionCount
+  data.insert(data.end(), {3, static_cast<u8>(kFunctionCount + 1)});
+  data.push_back(kFunctionCount);
+  data.insert(data.end(), kFunctionCount, 0);
+  // code
+  data.insert(data.end(), {10, static_cast<u8>(code.size() | 0x80),
+                           static_cast<u8>(code.size() >> 7)});
+  data.insert(data.end(), code.begin(), code.end());
+
+  // The errors are reported in function order, no matter how many threads are
+  // used. The local count from each code header is used when reading `let`.
+  const std::vector<ExpectedError> expected = {
+      {{0, "module"}, {78, "opcode"}, {78, "Unknown opcode: 255"}},
+      {{0, "module"}, {79, "Expected final end instruction"}},
+      {{0, "module"}, {81, "Expected final end instruction"}},
+      {{0, "module"}, {122, "Unclosed block instruction"}},
+      {{0, "module"},
+       {161, "locals vector"},
+       {162, "locals"},
+       {162, "Too many locals: 4294967296"}},
+      {{0, "module"}, {166, "Expected final end instruction"}},
+      {{0, "module"}, {190, "code"}, {190, "Length extends past end: 5 > 1"}},
+      {{0, "module"},
+       {190, "Expected code section to have count 40, got 39"}},
+  };
+  for (int jobs : {1, 2, 4}) {
+    auto actual = ReadModule(data, ctx, CodeFormat::Unpacked, jobs);
+    EXPECT_FALSE(actual.has_value());
+    ExpectErrors(expected, errors, data);
+    errors.Clear();
+  }
+}
+
 TEST_F(BinaryReadModuleTest, BadMagic) {
   Fail({{0, "module"},
         {0, "magic"},
@@ -3719,6 +3719,42 @@ TEST_F(BinaryReadTest, U32_PastEnd) {
        "\xf0\xf0\xf0\xf0"_su8);
 }
 
+TEST_F(BinaryReadTest, VarInt_TrailingData) {
+  // Followed by enough data that the unchecked decoder is used.
+  auto check = [&](auto&& read, auto expected, SpanU8 data, size_t length) {
+    auto orig_data = data;
+    auto actual = read(&data, ctx);
+    ExpectNoErrors(errors);
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(expected, **actual);
+    EXPECT_EQ(orig_data.first(length), actual->loc());
+    EXPECT_EQ(orig_data.size() - length, data.size());
+  };
+
+  check(Read<u32>, 448u, "\xc0\x03\x00\x00\x00\x00"_su8, 2);
+  check(Read<u32>, 3892314112u, "\x80\x80\x80\xc0\x0e\x00"_su8, 5);
+  check(Read<s32>, -3648, "\xc0\x63\x00\x00\x00\x00"_su8, 2);
+  check(Read<s32>, -837011344, "\xf0\xf0\xf0\xf0\x7c\x00"_su8, 5);
+  check(Read<s64>, -12413554592,
+        "\xe0\xe0\xe0\xe0\x51\x00\x00\x00\x00\x00"_su8, 5);
+  check(Read<s64>, -3540960223848057090,
+        "\xfe\xed\xfe\xed\xfe\xed\xfe\xed\x4e\x00\x00"_su8, 9);
+}
+
+TEST_F(BinaryReadTest, VarInt_TrailingData_TooLong) {
+  // Malformed values must report the same errors with trailing data present.
+  Fail(Read<u32>,
+       {{0, "u32"},
+        {4, "Last byte of u32 must be zero extension: expected 0x2, got 0x12"}},
+       "\xf0\xf0\xf0\xf0\x12\x00"_su8);
+  Fail(Read<s32>,
+       {{0, "s32"},
+        {4,
+         "Last byte of s32 must be sign extension: expected "
+         "0x5 or 0x7d, got 0x15"}},
+       "\xf0\xf0\xf0\xf0\x15\x00"_su8);
+}
+
 TEST_F(BinaryReadTest, U8) {
   OK(Read<u8>, 32, "\x20"_su8);
   Fail(Read<u8>, {{0, "Unable to read u8"}}, ""_su8);
@@ -0,0 +1,211 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/stream_decoder.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/concat.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+namespace {
+
+// Same module as in visitor_test.cc.
+const u8 kTestModule[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0e, 0x03, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x60, 0x01, 0x7d, 0x01, 0x7d, 0x60, 0x00, 0x00,
+    0x02, 0x0b, 0x01, 0x03, 0x66, 0x6f, 0x6f, 0x03, 0x62, 0x61, 0x72, 0x00,
+    0x00, 0x03, 0x03, 0x02, 0x01, 0x02, 0x04, 0x05, 0x01, 0x70, 0x01, 0x01,
+    0x02, 0x05, 0x03, 0x01, 0x00, 0x01, 0x06, 0x06, 0x01, 0x7f, 0x00, 0x41,
+    0x01, 0x0b, 0x07, 0x08, 0x01, 0x04, 0x71, 0x75, 0x75, 0x78, 0x00, 0x01,
+    0x08, 0x01, 0x02, 0x09, 0x08, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x02, 0x00,
+    0x01, 0x0a, 0x0c, 0x02, 0x07, 0x00, 0x43, 0x00, 0x00, 0x28, 0x42, 0x0b,
+    0x02, 0x00, 0x0b, 0x0b, 0x0b, 0x01, 0x00, 0x41, 0x02, 0x0b, 0x05, 0x68,
+    0x65, 0x6c, 0x6c, 0x6f,
+};
+
+// Records each callback, so the results of visiting a whole module can be
+// compared with the results of visiting a stream.
+struct RecordingVisitor : visit::Visitor {
+  using Result = visit::Result;
+
+  Result Record(std::string s) {
+    events.push_back(std::move(s));
+    return Result::Ok;
+  }
+
+  Result BeginModule(LazyModule&) { return Record("BeginModule"); }
+  Result EndModule(LazyModule&) { return Record("EndModule"); }
+  Result OnSection(At<Section> s) { return Record(concat("Section ", s->id())); }
+  Result OnType(const At<DefinedType>& x) { return Record(concat(x)); }
+  Result OnImport(const At<Import>& x) { return Record(concat(x)); }
+  Result OnFunction(const At<Function>& x) { return Record(concat(x)); }
+  Result OnTable(const At<Table>& x) { return Record(concat(x)); }
+  Result OnMemory(const At<Memory>& x) { return Record(concat(x)); }
+  Result OnGlobal(const At<Global>& x) { return Record(concat(x)); }
+  Result OnExport(const At<Export>& x) { return Record(concat(x)); }
+  Result OnStart(const At<Start>& x) { return Record(concat(x)); }
+  Result OnElement(const At<ElementSegment>& x) { return Record(concat(x)); }
+  Result BeginCodeSection(LazyCodeSection sec) {
+    return Record(concat("BeginCodeSection ", sec.count->value()));
+  }
+  Result BeginCode(const At<Code>& x) { return Record(concat(x)); }
+  Result OnInstruction(const At<Instruction>& x) { return Record(concat(x)); }
+  Result EndCode(const At<Code>&) { return Record("EndCode"); }
+  Result EndCodeSection(LazyCodeSection) { return Record("EndCodeSection"); }
+  Result OnData(const At<DataSegment>& x) { return Record(concat(x)); }
+
+  std::vector<std::string> events;
+};
+
+auto VisitWhole(SpanU8 data) -> std::vector<std::string> {
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  LazyModule module = ReadLazyModule(data, features, errors);
+  visit::Visit(module, visitor);
+  ExpectNoErrors(errors);
+  return visitor.events;
+}
+
+}  // namespace
+
+TEST(BinaryStreamDecoderTest, ChunkSizes) {
+  auto expected = VisitWhole(SpanU8{kTestModule});
+
+  for (size_t chunk_size = 1; chunk_size <= sizeof(kTestModule);
+       ++chunk_size) {
+    Features features;
+    TestErrors errors;
+    RecordingVisitor visitor;
+    visit::StreamDecoder<RecordingVisitor> decoder{features, errors, visitor};
+
+    SpanU8 data{kTestModule};
+    while (!data.empty()) {
+      auto chunk = data.first(std::min(chunk_size, data.size()));
+      data.remove_prefix(chunk.size());
+      EXPECT_EQ(visit::Result::Ok, decoder.Append(chunk));
+    }
+    EXPECT_EQ(visit::Result::Ok, decoder.Finish());
+
+    ExpectNoErrors(errors);
+    EXPECT_EQ(expected, visitor.events) << "chunk size: " << chunk_size;
+  }
+}
+
+TEST(BinaryStreamDecoderTest, CodeBodiesBeforeSectionEnd) {
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  visit::StreamDecoder<RecordingVisitor> decoder{features, errors, visitor};
+
+  // Everything up to and including the first code body, but not the second.
+  const size_t kFirstBodyEnd = 96;
+  ASSERT_EQ(0x0b, kTestModule[kFirstBodyEnd - 1]);
+  decoder.Append(SpanU8{kTestModule}.first(kFirstBodyEnd));
+
+  ASSERT_FALSE(visitor.events.empty());
+  EXPECT_EQ("EndCode", visitor.events.back());
+  // The length of the second body isn't known yet.
+  EXPECT_EQ(1u, decoder.bytes_needed());
+
+  // The second body has length 2.
+  decoder.Append(SpanU8{kTestModule}.subspan(kFirstBodyEnd, 1));
+  EXPECT_EQ(2u, decoder.bytes_needed());
+}
+
+TEST(BinaryStreamDecoderTest, BytesNeeded) {
+  Features features;
+  TestErrors errors;
+  visit::Visitor visitor;
+  visit::StreamDecoder<visit::Visitor> decoder{features, errors, visitor};
+
+  EXPECT_EQ(8u, decoder.bytes_needed());
+  decoder.Append(SpanU8{kTestModule}.first(3));
+  EXPECT_EQ(5u, decoder.bytes_needed());
+  decoder.Append(SpanU8{kTestModule}.subspan(3, 5));
+  // Section id and length aren't known yet.
+  EXPECT_EQ(1u, decoder.bytes_needed());
+  decoder.Append(SpanU8{kTestModule}.subspan(8, 2));
+  // Type section has length 0x0e.
+  EXPECT_EQ(14u, decoder.bytes_needed());
+}
+
+TEST(BinaryStreamDecoderTest, Truncated) {
+  Features features;
+  TestErrors errors;
+  visit::Visitor visitor;
+  visit::StreamDecoder<visit::Visitor> decoder{features, errors, visitor};
+
+  EXPECT_EQ(visit::Result::Ok,
+            decoder.Append(SpanU8{kTestModule}.first(sizeof(kTestModule) - 1)));
+  EXPECT_EQ(visit::Result::Fail, decoder.Finish());
+  EXPECT_TRUE(errors.HasError());
+  EXPECT_EQ(0u, decoder.bytes_needed());
+}
+
+TEST(BinaryStreamDecoderTest, SectionTooLarge) {
+  // A code section that declares a length of 0xffffffff, which is more than
+  // the default limit. It is rejected without waiting for more data.
+  const u8 data[] = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+                     0x0a, 0xff, 0xff, 0xff, 0xff, 0x0f};
+  Features features;
+  TestErrors errors;
+  visit::Visitor visitor;
+  visit::StreamDecoder<visit::Visitor> decoder{features, errors, visitor};
+
+  EXPECT_EQ(visit::Result::Fail, decoder.Append(SpanU8{data}));
+  // The locations refer to the decoder's copy of the data, so only the
+  // message is checked.
+  ASSERT_EQ(1u, errors.errors.size());
+  EXPECT_EQ("Section length 4294967295 exceeds maximum 1073741824",
+            errors.errors[0].back().message);
+  EXPECT_EQ(0u, decoder.bytes_needed());
+}
+
+TEST(BinaryStreamDecoderTest, MaxSectionSize) {
+  // The type section has length 0x0e.
+  Features features;
+  TestErrors errors;
+  visit::Visitor visitor;
+  visit::StreamDecoder<visit::Visitor> decoder{features, errors, visitor, 13};
+
+  EXPECT_EQ(visit::Result::Fail, decoder.Append(SpanU8{kTestModule}));
+  ASSERT_EQ(1u, errors.errors.size());
+  EXPECT_EQ("Section length 14 exceeds maximum 13",
+            errors.errors[0].back().message);
+}
+
+TEST(BinaryStreamDecoderTest, BadMagic) {
+  const u8 data[] = {0x00, 0x61, 0x73, 0x6e, 0x01, 0x00, 0x00, 0x00};
+  Features features;
+  TestErrors errors;
+  visit::Visitor visitor;
+  visit::StreamDecoder<visit::Visitor> decoder{features, errors, visitor};
+
+  EXPECT_EQ(visit::Result::Fail, decoder.Append(SpanU8{data}));
+  EXPECT_TRUE(errors.HasError());
+}
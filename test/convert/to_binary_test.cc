@@ -1249,6 +1249,8 @@ TEST_F(ConvertToBinaryTest, Module) {
             {At{loc23,
                 binary::DataSegment{At{loc24, Index{0}},
                                     binary_constant_expression, "hello"_su8}}},
+            // packed_codes
+            {},
         }},
      At{loc1,
         text::Module{
@@ -1361,6 +1363,8 @@ TEST_F(ConvertToBinaryTest, DataCount_BulkMemory) {
                                                               Opcode::I32Const},
                                                            At{loc7, s32{0}}}}}},
                     "hello"_su8}}},
+            // packed_codes
+            {},
         }},
      At{loc1,
         text::Module{
@@ -811,6 +811,28 @@ TEST(ConvertToTextTest, Instruction) {
                                At{loc4, Index{13}}, At{loc5, Index{14}}}}}});
 }
 
+TEST(ConvertToTextTest, PackedExpression) {
+  // i32.const 0; end
+  const SpanU8 base = "\x41\x00\x0b"_su8;
+  const SpanU8 i32_const = base.subspan(0, 2);
+  const SpanU8 end = base.subspan(2, 1);
+
+  OK(text::InstructionList{
+         At{i32_const,
+            text::Instruction{At{i32_const.first(1), Opcode::I32Const},
+                              At{i32_const.last(1), s32{0}}}},
+         At{end, text::Instruction{At{end, Opcode::End}}},
+     },
+     binary::PackedExpression{
+         base, binary::InstructionList{
+                   At{i32_const,
+                      binary::Instruction{
+                          At{i32_const.first(1), Opcode::I32Const},
+                          At{i32_const.last(1), s32{0}}}},
+                   At{end, binary::Instruction{At{end, Opcode::End}}},
+               }});
+}
+
 TEST(ConvertToTextTest, LocalsList) {
   OK(
       text::BoundValueTypeList{
@@ -1046,5 +1068,7 @@ TEST(ConvertToTextTest, Module) {
             {At{loc23,
                 binary::DataSegment{At{loc24, Index{0}},
                                     binary_constant_expression, "hello"_su8}}},
+            // packed_codes
+            {},
         }});
 }
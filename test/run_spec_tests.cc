@@ -166,13 +166,13 @@ void DoFile(const fs::path& path, const Features& features) {
   }
 
   std::string filename = path.string();
-  auto data = ReadFile(filename);
-  if (!data) {
+  auto file = MapFile(filename, FileAccess::Sequential);
+  if (!file) {
     Format(&std::cerr, "Error reading file %s", path.filename().string());
     return;
   }
 
-  Tool tool{filename, *data, features};
+  Tool tool{filename, file->span(), features};
   tool.Run();
 }
 
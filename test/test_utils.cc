@@ -16,6 +16,8 @@
 
 #include "test/test_utils.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
 
 namespace wasp::test {
@@ -111,4 +113,67 @@ void ExpectError(const ErrorList& expected, const TestErrors& errors) {
   ExpectErrors({expected}, errors);
 }
 
+void AppendU32Leb128(std::vector<u8>& data, u32 value) {
+  do {
+    u8 byte = value & 0x7f;
+    value >>= 7;
+    data.push_back(value ? byte | 0x80 : byte);
+  } while (value);
+}
+
+namespace {
+
+void AppendSection(std::vector<u8>& data,
+                   u8 id,
+                   Index count,
+                   const std::vector<u8>& contents) {
+  std::vector<u8> section;
+  AppendU32Leb128(section, count);
+  section.insert(section.end(), contents.begin(), contents.end());
+  data.push_back(id);
+  AppendU32Leb128(data, static_cast<u32>(section.size()));
+  data.insert(data.end(), section.begin(), section.end());
+}
+
+}  // namespace
+
+std::vector<u8> MakeModule(const std::vector<std::vector<u8>>& bodies,
+                           Index import_count,
+                           Index export_count) {
+  const auto count = static_cast<Index>(bodies.size());
+  std::vector<u8> data{0, 'a', 's', 'm', 1, 0, 0, 0};
+  // type: (func)
+  AppendSection(data, 1, 1, {0x60, 0, 0});
+  // import: (import "m" "f" (func (type 0))) * import_count
+  if (import_count) {
+    std::vector<u8> imports;
+    for (Index i = 0; i < import_count; ++i) {
+      imports.insert(imports.end(), {1, 'm', 1, 'f', 0, 0});
+    }
+    AppendSection(data, 2, import_count, imports);
+  }
+  // func: (func (type 0)) * count
+  AppendSection(data, 3, count, std::vector<u8>(count, 0));
+  // export: (export "0" (func 0)), (export "1" (func 1)), ...
+  if (export_count) {
+    std::vector<u8> exports;
+    for (Index i = 0; i < export_count; ++i) {
+      auto name = std::to_string(i);
+      AppendU32Leb128(exports, static_cast<u32>(name.size()));
+      exports.insert(exports.end(), name.begin(), name.end());
+      exports.push_back(0);
+      AppendU32Leb128(exports, i);
+    }
+    AppendSection(data, 7, export_count, exports);
+  }
+  // code
+  std::vector<u8> code;
+  for (const auto& body : bodies) {
+    AppendU32Leb128(code, static_cast<u32>(body.size()));
+    code.insert(code.end(), body.begin(), body.end());
+  }
+  AppendSection(data, 10, count, code);
+  return data;
+}
+
 }  // namespace wasp::test
@@ -58,6 +58,18 @@ void ExpectError(const ExpectedError&, const TestErrors&, SpanU8 orig_data);
 void ExpectErrors(const std::vector<ErrorList>&, const TestErrors&);
 void ExpectError(const ErrorList&, const TestErrors&);
 
+// Append `value` to `data` as an unsigned LEB128.
+void AppendU32Leb128(std::vector<u8>& data, u32 value);
+
+// Create a binary module with one defined function of type (func) per body.
+// Each body is the encoded locals and instructions, without its size.
+//
+// The module first imports `import_count` functions of type (func) as "m" "f",
+// and exports functions 0 through `export_count - 1` as "0", "1", ...
+std::vector<u8> MakeModule(const std::vector<std::vector<u8>>& bodies,
+                           Index import_count = 0,
+                           Index export_count = 0);
+
 }  // namespace wasp::test
 
 #endif // WASP_TEST_UTILS_H_
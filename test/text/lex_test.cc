@@ -17,6 +17,7 @@
 #include "wasp/text/read/lex.h"
 
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -157,6 +158,39 @@ TEST(LexTest, Whitespace) {
   ExpectLex({9, TT::Whitespace}, " \n\t \n\t \n\t"_su8);
 }
 
+// Runs that are longer than a SIMD block, and end at every offset in one.
+TEST(LexTest, LongRuns) {
+  auto span = [](const std::string& str) {
+    return SpanU8{reinterpret_cast<const u8*>(str.data()), str.size()};
+  };
+  for (span_extent_t n = 1; n <= 70; ++n) {
+    const std::string run(n, 'x');
+    ExpectLex({n, TT::Whitespace}, span(std::string(n, ' ') + "x"));
+    ExpectLex({n, TT::Reserved}, span(run + ")"));
+    ExpectLex({n + 3, TT::LineComment}, span(";;" + run + "\n;;"));
+    ExpectLex({n + 2, TT::InvalidLineComment}, span(";;" + run));
+    ExpectLex({n + 4, TT::BlockComment}, span("(;" + run + ";)(;;)"));
+
+    const std::string text = "\"" + run + "\\n\"";
+    ExpectLex({n + 4, TT::Text,
+               Text{string_view{text}, static_cast<u32>(n + 1)}},
+              span(text + "\""));
+    ExpectLex({n + 2, TT::InvalidText}, span("\"" + run + "\n"));
+  }
+
+  // Each byte value ends a run of reserved chars iff it is not reserved.
+  const string_view not_reserved = "\"(),;[]{}";
+  for (int c = 0; c < 256; ++c) {
+    bool is_reserved =
+        c >= '!' && c <= '~' &&
+        std::find(not_reserved.begin(), not_reserved.end(), c) ==
+            not_reserved.end();
+    const std::string str =
+        std::string(40, 'x') + static_cast<char>(c) + "x ";
+    ExpectLex({is_reserved ? 42u : 40u, TT::Reserved}, span(str));
+  }
+}
+
 TEST(LexTest, AlignEqNat) {
   ExpectLex({9, TT::AlignEqNat, LI::Nat(HU::No)}, "align=123"_su8);
   ExpectLex({11, TT::AlignEqNat, LI::Nat(HU::Yes)}, "align=1_234"_su8);
@@ -1228,3 +1262,25 @@ TEST(LexTest, Tokenizer) {
     EXPECT_EQ(0, t.count());
   }
 }
+
+TEST(LexTest, SplitSExpressions) {
+  auto span = "(a) ;; (\n (b (c \"()\\\"\") (; ) (; ) ;) ;)) \t(d)"_su8;
+  EXPECT_EQ((std::vector<SpanU8>{span.subspan(0, 3), span.subspan(10, 30),
+                                 span.subspan(42, 3)}),
+            SplitSExpressions(span));
+
+  // Stops at anything but whitespace, comments and s-expressions.
+  EXPECT_EQ((std::vector<SpanU8>{"(a)"_su8.subspan(0, 3)}),
+            SplitSExpressions("(a) b (c)"_su8));
+
+  // Stops at an unbalanced s-expression or comment.
+  span = "(a) (b))(c)"_su8;
+  EXPECT_EQ((std::vector<SpanU8>{span.subspan(0, 3), span.subspan(4, 3)}),
+            SplitSExpressions(span));
+  span = "(a) (b (c)"_su8;
+  EXPECT_EQ((std::vector<SpanU8>{span.subspan(0, 3)}), SplitSExpressions(span));
+  span = "(a) (; (b)"_su8;
+  EXPECT_EQ((std::vector<SpanU8>{span.subspan(0, 3)}), SplitSExpressions(span));
+  span = "(a) (b \")"_su8;
+  EXPECT_EQ((std::vector<SpanU8>{span.subspan(0, 3)}), SplitSExpressions(span));
+}
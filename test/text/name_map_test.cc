@@ -16,6 +16,9 @@
 
 #include "wasp/text/read/name_map.h"
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 using namespace ::wasp;
@@ -128,3 +131,57 @@ TEST(TextNameMapTest, LetBindings) {
   ExpectGet(map, "$a"_sv, 0);
   ExpectGet(map, "$c"_sv, 2);
 }
+
+TEST(TextNameMapTest, ShadowThenPop) {
+  NameMap map;
+  map.NewBound("$a"_sv);
+  map.NewBound("$b"_sv);
+
+  map.Push();
+  map.NewBound("$b"_sv);
+  map.NewBound("$c"_sv);
+  // 0  1  2  3
+  // $b $c $a $b
+  ExpectGet(map, "$a"_sv, 2);
+  ExpectGet(map, "$b"_sv, 0);
+  ExpectGet(map, "$c"_sv, 1);
+  EXPECT_TRUE(map.HasSinceLastPush("$b"_sv));
+  EXPECT_FALSE(map.HasSinceLastPush("$a"_sv));
+
+  map.Pop();
+  ExpectGet(map, "$a"_sv, 0);
+  ExpectGet(map, "$b"_sv, 1);
+  EXPECT_FALSE(map.Has("$c"_sv));
+  EXPECT_FALSE(map.NewBound("$b"_sv));
+}
+
+TEST(TextNameMapTest, ManyNames) {
+  // Large enough that a linear search per lookup would be very slow.
+  const Index count = 100000;
+  std::vector<std::string> names;
+  for (Index i = 0; i < count; ++i) {
+    names.push_back("$f" + std::to_string(i));
+  }
+
+  NameMap map;
+  for (auto&& name : names) {
+    EXPECT_TRUE(map.NewBound(name));
+  }
+  for (Index i = 0; i < count; ++i) {
+    EXPECT_EQ(map.Get(names[i]), i);
+  }
+
+  // One label per name, as in deeply nested blocks.
+  NameMap labels;
+  for (auto&& name : names) {
+    labels.Push();
+    labels.NewBound(name);
+  }
+  for (Index i = 0; i < count; ++i) {
+    EXPECT_EQ(labels.Get(names[i]), count - 1 - i);
+  }
+  for (Index i = 0; i < count; ++i) {
+    labels.Pop();
+  }
+  EXPECT_EQ(0u, labels.Size());
+}
@@ -229,6 +229,40 @@ TEST(TextNumericTest, StrToInt_u32) {
   Test_StrToInt32<u32>();
 }
 
+TEST(TextNumericTest, StrToNat_u64) {
+  using T = u64;
+  struct {
+    SpanU8 span;
+    LiteralInfo info;
+    optional<T> value;
+  } tests[] = {
+      // Runs of 8 digits, with and without underscores.
+      {"12345678"_su8, LI::Nat(HU::No), 12345678},
+      {"123456789012345678"_su8, LI::Nat(HU::No), 123456789012345678ull},
+      {"1234567_89012345678"_su8, LI::Nat(HU::Yes), 123456789012345678ull},
+      {"1234_5678_9012"_su8, LI::Nat(HU::Yes), 123456789012ull},
+      {"9999999999999999999"_su8, LI::Nat(HU::No), 9999999999999999999ull},
+      {"18446744073709551615"_su8, LI::Nat(HU::No), T(-1)},
+      {"18_446_744_073_709_551_615"_su8, LI::Nat(HU::Yes), T(-1)},
+      {"000000000000000000018446744073709551615"_su8, LI::Nat(HU::No), T(-1)},
+      {"18446744073709551616"_su8, LI::Nat(HU::No), nullopt},
+      {"99999999999999999999"_su8, LI::Nat(HU::No), nullopt},
+
+      {"0xffffffffffffffff"_su8, LI::HexNat(HU::No), T(-1)},
+      {"0xffff_ffff_ffff_ffff"_su8, LI::HexNat(HU::Yes), T(-1)},
+      {"0x10000000000000000"_su8, LI::HexNat(HU::No), nullopt},
+  };
+  for (auto test : tests) {
+    EXPECT_EQ(test.value, StrToNat<T>(test.info, test.span))
+        << ToStringView(test.span);
+  }
+
+  // The unchecked path still rejects values too large for smaller types.
+  EXPECT_EQ(nullopt, StrToNat<u32>(LI::Nat(HU::No), "4294967296"_su8));
+  EXPECT_EQ(nullopt, StrToNat<u32>(LI::Nat(HU::No), "12345678901"_su8));
+  EXPECT_EQ(nullopt, StrToNat<u8>(LI::HexNat(HU::No), "0x100"_su8));
+}
+
 template <typename Float, typename Int>
 void ExpectFloat(SpanU8 span, LiteralInfo info, Int expected) {
   static_assert(sizeof(Float) == sizeof(Int), "size mismatch");
@@ -527,6 +561,28 @@ TEST(TextNumericTest, StrToFloat_f64_OutOfRange) {
 }
 
 
+TEST(TextNumericTest, StrToFloat_Underflow) {
+  // Values that are too small to represent round to zero.
+  ExpectFloat<f32, u32>("1e-50"_su8, LI::Number(Sign::None, HU::No), 0);
+  ExpectFloat<f32, u32>("-1e-50"_su8, LI::Number(Sign::Minus, HU::No),
+                        0x80000000);
+  ExpectFloat<f32, u32>("0x1p-160"_su8, LI::HexNumber(Sign::None, HU::No), 0);
+  ExpectFloat<f64, u64>("1e-400"_su8, LI::Number(Sign::None, HU::No), 0);
+  ExpectFloat<f64, u64>("0x1p-1100"_su8, LI::HexNumber(Sign::None, HU::No),
+                        0);
+}
+
+TEST(TextNumericTest, StrToFloat_LongUnderscores) {
+  // Longer than the inline buffer used to remove underscores.
+  ExpectFloat<f64, u64>(
+      "1_000_000_000_000_000_000_000_000_000_000_000_000_000_000.000_000_000_1"
+      ""_su8,
+      LI::Number(Sign::None, HU::Yes), 0x48a6'f578'c4e0'a061ull);
+  ExpectFloat<f32, u32>(
+      "0x1_0000_0000_0000_0000_0000_0000_0000_0000.0000_0001p-128"_su8,
+      LI::HexNumber(Sign::None, HU::Yes), 0x3f80'0000);
+}
+
 TEST(TextNumericTest, NatToStr_u8) {
   struct {
     string_view result;
@@ -16,6 +16,8 @@
 
 #include "wasp/text/read.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
 #include "test/test_utils.h"
 #include "test/text/constants.h"
@@ -23,6 +25,7 @@
 #include "wasp/text/formatters.h"
 #include "wasp/text/read/macros.h"
 #include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/token_buffer.h"
 #include "wasp/text/read/tokenizer.h"
 
 using namespace ::wasp;
@@ -3155,3 +3158,70 @@ TEST_F(TextReadTest, SingleModule) {
      },
      "(start 0)"_su8);
 }
+
+TEST_F(TextReadTest, ModuleParallel) {
+  // Many fields, so more than one thread is used.
+  std::string many;
+  for (int i = 0; i < 100; ++i) {
+    many += "(func (param i32) (local.get 0) drop) (; a ( comment ;)\n";
+  }
+  // An import after a non-import, and a second start function.
+  many += "(import \"m\" \"n\" (func)) (start 0) (start 0)";
+
+  const SpanU8 tests[] = {
+      // Strings and comments that contain parentheses.
+      "(type $t (func (param i32)))\n"
+      "(import \"m\" \"f(\" (func $i (type $t)))\n"
+      ";; ( unbalanced in a line comment\n"
+      "(func $f (export \"a)\") (local i32) (; nested (; ( ;) ;)\n"
+      "  (block (result i32) (i32.const 1)) drop)\n"
+      "(memory 1) (data (i32.const 0) \"\\\")\")\n"
+      "(global i32 (i32.const 0)) (start $f)"_su8,
+      // Fields that depend on earlier fields.
+      "(func) (import \"m\" \"n\" (func))"_su8,
+      "(func) (func (import \"m\" \"n\"))"_su8,
+      "(start 0) (func) (start 0)"_su8,
+      "(func) (event (import \"m\" \"e\") (param i32))"_su8,
+      // A field that fails to read.
+      "(func) (func (param i32 (i32))) (func)"_su8,
+      // Something other than a module field.
+      "(func) (memory 1) (module) (func)"_su8,
+      "(func) 0 (func)"_su8,
+      "(func) (func) (func))"_su8,
+      // Unbalanced parentheses.
+      "(func) (func (i32.const 0) (func)"_su8,
+      SpanU8{reinterpret_cast<const u8*>(many.data()), many.size()},
+  };
+
+  Features features;
+  features.enable_exceptions();
+
+  for (auto span : tests) {
+    TestErrors serial_errors;
+    ReadCtx serial_ctx{features, serial_errors};
+    Tokenizer serial_tokenizer{span};
+    auto expected = ReadModule(serial_tokenizer, serial_ctx);
+
+    TestErrors parallel_errors;
+    ReadCtx parallel_ctx{features, parallel_errors};
+    Tokenizer parallel_tokenizer{span};
+    auto actual = ReadModuleParallel(parallel_tokenizer, parallel_ctx, 4);
+
+    EXPECT_EQ(expected, actual);
+    ExpectErrors(serial_errors.errors, parallel_errors);
+    EXPECT_EQ(serial_tokenizer.Peek(), parallel_tokenizer.Peek());
+    EXPECT_EQ(serial_tokenizer.Previous(), parallel_tokenizer.Previous());
+
+    // The same, reading from a TokenBuffer.
+    TestErrors buffered_errors;
+    ReadCtx buffered_ctx{features, buffered_errors};
+    TokenBuffer buffer{span};
+    Tokenizer buffered_tokenizer{buffer};
+    actual = ReadModuleParallel(buffered_tokenizer, buffered_ctx, 4);
+
+    EXPECT_EQ(expected, actual);
+    ExpectErrors(serial_errors.errors, buffered_errors);
+    EXPECT_EQ(serial_tokenizer.Peek(), buffered_tokenizer.Peek());
+    EXPECT_EQ(serial_tokenizer.Previous(), buffered_tokenizer.Previous());
+  }
+}
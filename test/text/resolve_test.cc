@@ -243,6 +243,45 @@ TEST_F(TextResolveTest, FunctionTypeUse_DeferType) {
       defined_types[0]);
 }
 
+TEST_F(TextResolveTest, FunctionTypeMap_IgnoresLocations) {
+  FunctionTypeMap& ftm = ctx.function_type_map;
+
+  ftm.Define(BoundFunctionType{{BVT{nullopt, VT_I32}}, {}});
+  ftm.Define(BoundFunctionType{{BVT{nullopt, VT_I32}}, {}});
+
+  // The first matching type is used, wherever it was written.
+  EXPECT_EQ(0u, ftm.Use(FunctionType{{At{loc1, VT_I32}}, {}}));
+  EXPECT_EQ(2u, ftm.Use(FunctionType{{}, {At{loc1, VT_I64}}}));
+  EXPECT_EQ(2u, ftm.Use(FunctionType{{}, {VT_I64}}));
+  EXPECT_EQ(3u, ftm.Use(FunctionType{{VT_I64}, {}}));
+
+  ftm.EndModule();
+  ASSERT_EQ(4u, ftm.Size());
+  EXPECT_EQ(2u, ftm.Use(FunctionType{{}, {VT_I64}}));
+}
+
+TEST_F(TextResolveTest, FunctionTypeMap_ManyTypes) {
+  FunctionTypeMap& ftm = ctx.function_type_map;
+
+  // Distinct types, each written with params from the bits of its index.
+  const Index count = 20000;
+  auto make_type = [](Index index) {
+    FunctionType type;
+    for (Index bits = index; bits != 0; bits >>= 1) {
+      type.params.push_back((bits & 1) ? VT_I64 : VT_I32);
+    }
+    return type;
+  };
+  for (Index i = 0; i < count; ++i) {
+    EXPECT_EQ(i, ftm.Use(make_type(i)));
+  }
+  // Repeated types.
+  for (Index i = 0; i < count; ++i) {
+    EXPECT_EQ(i, ftm.Use(make_type(i)));
+  }
+  EXPECT_EQ(count, ftm.EndModule().size());
+}
+
 TEST_F(TextResolveTest, FunctionTypeUse_NoFunctionTypeInContext) {
   FunctionTypeUse type_use;
   Resolve(ctx, type_use);
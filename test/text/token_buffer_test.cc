@@ -0,0 +1,142 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/text/read/token_buffer.h"
+
+#include "gtest/gtest.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/text/formatters.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/lex.h"
+#include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/types.h"
+
+using namespace ::wasp;
+using namespace ::wasp::text;
+
+namespace {
+
+const SpanU8 kSource =
+    "(module $m\n"
+    "  (type (func (param i32 f64) (result externref)))\n"
+    "  (memory 1) (data \"h\\65llo\")  ;; comment\n"
+    "  (func (local (ref null func) i8 i16 anyref) (; block ;)\n"
+    "    i32.add i64.atomic.rmw.add offset=4 align=8\n"
+    "    f32.const nan:0x1_0 f64.const -inf i32.const +0xff\n"
+    "    v128.const i8x16 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15\n"
+    "    br_table 0 1 2 (rtt 1 $t) @ bad\"\n"_su8;
+
+}  // namespace
+
+TEST(TextTokenBufferTest, MatchesLex) {
+  TokenBuffer buffer{kSource};
+
+  auto data = kSource;
+  Index index = 0;
+  while (true) {
+    auto expected = LexNoWhitespace(&data);
+    EXPECT_EQ(expected, buffer.Get(index++));
+    if (expected.type == TokenType::Eof) {
+      break;
+    }
+  }
+  EXPECT_EQ(index, buffer.size());
+}
+
+TEST(TextTokenBufferTest, GetPastEnd) {
+  auto span = "(module)"_su8;
+  TokenBuffer buffer{span};
+
+  Token eof{span.subspan(8, 0), TokenType::Eof};
+  ASSERT_EQ(4u, buffer.size());
+  EXPECT_EQ(eof, buffer.Get(3));
+  EXPECT_EQ(eof, buffer.Get(4));
+  EXPECT_EQ(eof, buffer.Get(100));
+}
+
+TEST(TextTokenBufferTest, TooLarge) {
+  if constexpr (sizeof(size_t) > sizeof(u32)) {
+    // The data is never read, only its size is checked.
+    auto span = "(module)"_su8;
+    SpanU8 large{span.data(), TokenBuffer::kMaxSize + 1};
+    TokenBuffer buffer{large};
+    EXPECT_FALSE(buffer.is_buffered());
+    EXPECT_EQ(0u, buffer.size());
+
+    // The Tokenizer falls back to lexing on demand, so nothing is lexed yet.
+    Tokenizer t{buffer};
+    EXPECT_EQ(0, t.count());
+  }
+}
+
+TEST(TextTokenBufferTest, Tokenizer) {
+  auto span = "(module (func (param i32)))"_su8;
+  TokenBuffer buffer{span};
+  Tokenizer t{buffer};
+
+  std::vector<Token> tokens = {
+      {span.subspan(0, 1), TokenType::Lpar},
+      {span.subspan(1, 6), TokenType::Module},
+      {span.subspan(8, 1), TokenType::Lpar},
+      {span.subspan(9, 4), TokenType::Func, HeapKind::Func},
+      {span.subspan(14, 1), TokenType::Lpar},
+      {span.subspan(15, 5), TokenType::Param},
+      {span.subspan(21, 3), TokenType::NumericType, NumericType::I32},
+      {span.subspan(24, 1), TokenType::Rpar},
+      {span.subspan(25, 1), TokenType::Rpar},
+      {span.subspan(26, 1), TokenType::Rpar},
+      {span.subspan(27, 0), TokenType::Eof},
+  };
+
+  // Unlimited lookahead.
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens[i], t.Peek(i));
+  }
+
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens[i], t.Peek());
+    EXPECT_EQ(tokens[i], t.Read());
+    EXPECT_EQ(tokens[i], t.Previous());
+  }
+
+  // Reading past the end keeps returning Eof.
+  EXPECT_EQ(tokens.back(), t.Read());
+  EXPECT_EQ(tokens.back(), t.Peek(5));
+}
+
+TEST(TextTokenBufferTest, ReadModule) {
+  auto span =
+      "(type $t (func (param i32)))\n"
+      "(func $f (type $t) (local i64)\n"
+      "  (block (result i32) (i32.const 1))\n"
+      "  drop local.get 0 call $f)\n"
+      "(export \"f\" (func $f))\n"_su8;
+
+  ErrorsNop errors;
+  Tokenizer lexing{span};
+  ReadCtx lexing_ctx{Features{}, errors};
+  auto expected = ReadModule(lexing, lexing_ctx);
+  ASSERT_TRUE(expected.has_value());
+
+  TokenBuffer buffer{span};
+  Tokenizer buffered{buffer};
+  ReadCtx buffered_ctx{Features{}, errors};
+  auto actual = ReadModule(buffered, buffered_ctx);
+  ASSERT_TRUE(actual.has_value());
+
+  EXPECT_EQ(*expected, *actual);
+}
@@ -122,6 +122,18 @@ TEST(ArgParserTest, Bare) {
   EXPECT_EQ("world", bare[1]);
 }
 
+TEST(ArgParserTest, BareDash) {
+  std::vector<string_view> bare;
+
+  ArgParser parser{"prog"};
+  parser.Add("metavar", "help", [&](string_view arg) { bare.push_back(arg); });
+
+  std::vector<string_view> args{{"-"}};
+  parser.Parse(args);
+  ASSERT_EQ(1, bare.size());
+  EXPECT_EQ("-", bare[0]);
+}
+
 TEST(ArgParserTest, BareWithFlags) {
   int count = 0;
   std::vector<string_view> bare;
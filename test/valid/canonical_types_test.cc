@@ -0,0 +1,163 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/canonical_types.h"
+
+#include "gtest/gtest.h"
+
+#include "test/binary/constants.h"
+
+using namespace ::wasp;
+using namespace ::wasp::valid;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+DefinedType Func(const ValueTypeList& params, const ValueTypeList& results) {
+  return DefinedType{FunctionType{params, results}};
+}
+
+ValueType Ref(Index index, Null null = Null::No) {
+  return ValueType{ReferenceType{RefType{HeapType{At{index}}, null}}};
+}
+
+ValueType RefNull(Index index) {
+  return Ref(index, Null::Yes);
+}
+
+}  // namespace
+
+TEST(ValidCanonicalTypesTest, Simple) {
+  std::vector<DefinedType> types{
+      Func({VT_I32}, {}),  // 0
+      Func({VT_F32}, {}),  // 1
+      Func({VT_I32}, {}),  // 2
+      Func({}, {VT_I32}),  // 3
+  };
+  CanonicalTypes canon;
+  canon.Update(types);
+  EXPECT_TRUE(canon.IsValid(3));
+  EXPECT_FALSE(canon.IsValid(4));
+  EXPECT_EQ(canon.Get(0), canon.Get(2));
+  EXPECT_NE(canon.Get(0), canon.Get(1));
+  EXPECT_NE(canon.Get(0), canon.Get(3));
+  EXPECT_NE(canon.Get(1), canon.Get(3));
+}
+
+TEST(ValidCanonicalTypesTest, Recursive) {
+  std::vector<DefinedType> types{
+      Func({VT_I32}, {Ref(0)}),  // 0
+      Func({VT_I32}, {Ref(2)}),  // 1: Same as 0, via 2.
+      Func({VT_I32}, {Ref(1)}),  // 2: Same as 0, via 1.
+      Func({VT_I32}, {Ref(4)}),  // 3
+      Func({VT_I32}, {Ref(5)}),  // 4
+      Func({VT_F32}, {Ref(3)}),  // 5: Differs, so 3 and 4 do too.
+  };
+  CanonicalTypes canon;
+  canon.Update(types);
+  EXPECT_EQ(canon.Get(0), canon.Get(1));
+  EXPECT_EQ(canon.Get(0), canon.Get(2));
+  EXPECT_NE(canon.Get(0), canon.Get(3));
+  EXPECT_NE(canon.Get(0), canon.Get(4));
+  EXPECT_NE(canon.Get(3), canon.Get(4));
+  EXPECT_NE(canon.Get(4), canon.Get(5));
+}
+
+TEST(ValidCanonicalTypesTest, StructAndArray) {
+  FieldType i32_const{StorageType{VT_I32}, Mutability::Const};
+  FieldType i32_var{StorageType{VT_I32}, Mutability::Var};
+  FieldType i8_var{StorageType{PackedType::I8}, Mutability::Var};
+  std::vector<DefinedType> types{
+      DefinedType{StructType{FieldTypeList{i32_const}}},          // 0
+      DefinedType{StructType{FieldTypeList{i32_var}}},            // 1
+      DefinedType{StructType{FieldTypeList{i32_const}}},          // 2
+      DefinedType{StructType{FieldTypeList{i32_const, i8_var}}},  // 3
+      DefinedType{ArrayType{i32_const}},                          // 4
+      DefinedType{ArrayType{i8_var}},                             // 5
+      DefinedType{ArrayType{i32_const}},                          // 6
+  };
+  CanonicalTypes canon;
+  canon.Update(types);
+  EXPECT_EQ(canon.Get(0), canon.Get(2));
+  EXPECT_NE(canon.Get(0), canon.Get(1));
+  EXPECT_NE(canon.Get(0), canon.Get(3));
+  EXPECT_NE(canon.Get(0), canon.Get(4));
+  EXPECT_EQ(canon.Get(4), canon.Get(6));
+  EXPECT_NE(canon.Get(4), canon.Get(5));
+}
+
+TEST(ValidCanonicalTypesTest, NullableReference) {
+  std::vector<DefinedType> types{
+      Func({VT_Ref0}, {}),     // 0
+      Func({RefNull(1)}, {}),  // 1
+      Func({VT_Ref2}, {}),     // 2: Same as 0.
+  };
+  CanonicalTypes canon;
+  canon.Update(types);
+  EXPECT_EQ(canon.Get(0), canon.Get(2));
+  EXPECT_NE(canon.Get(0), canon.Get(1));
+}
+
+TEST(ValidCanonicalTypesTest, InvalidIndex) {
+  std::vector<DefinedType> types{
+      Func({RefNull(100)}, {}),  // 0
+      Func({RefNull(100)}, {}),  // 1
+      Func({RefNull(101)}, {}),  // 2
+  };
+  CanonicalTypes canon;
+  canon.Update(types);
+  EXPECT_EQ(canon.Get(0), canon.Get(1));
+  EXPECT_NE(canon.Get(0), canon.Get(2));
+}
+
+TEST(ValidCanonicalTypesTest, Update) {
+  std::vector<DefinedType> types{Func({VT_I32}, {})};
+  CanonicalTypes canon;
+  canon.Update(types);
+  EXPECT_TRUE(canon.IsValid(0));
+  EXPECT_FALSE(canon.IsValid(1));
+
+  types.push_back(Func({VT_I32}, {}));
+  canon.Update(types);
+  EXPECT_TRUE(canon.IsValid(1));
+  EXPECT_EQ(canon.Get(0), canon.Get(1));
+
+  canon.Reset();
+  EXPECT_FALSE(canon.IsValid(0));
+}
+
+TEST(ValidCanonicalTypesTest, Match) {
+  CanonicalTypes canon;
+  EXPECT_EQ(nullopt, canon.GetMatch(0, 1));
+
+  // A mismatch is cached, even if it was found under an assumption.
+  canon.AssumeMatch(0, 1);
+  EXPECT_EQ(true, canon.GetMatch(0, 1));
+  canon.AssumeMatch(2, 3);
+  canon.ResolveMatch(2, 3, false);
+  EXPECT_EQ(false, canon.GetMatch(2, 3));
+
+  // A match is only cached for the outermost check.
+  canon.AssumeMatch(4, 5);
+  canon.ResolveMatch(4, 5, true);
+  EXPECT_EQ(nullopt, canon.GetMatch(4, 5));
+  canon.ResolveMatch(0, 1, true);
+  EXPECT_EQ(true, canon.GetMatch(0, 1));
+
+  // Matching isn't symmetric.
+  EXPECT_EQ(nullopt, canon.GetMatch(1, 0));
+}
@@ -0,0 +1,122 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/incremental_validator.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+using namespace ::wasp::valid;
+
+namespace {
+
+const std::vector<u8> kNop = {0, 0x01, 0x0b};         // nop
+const std::vector<u8> kLeftover = {0, 0x41, 0, 0x0b};  // i32.const 0
+const std::vector<u8> kDrop = {0, 0x41, 0, 0x1a, 0x0b};  // i32.const 0; drop
+const std::vector<u8> kRefFunc = {0, 0xd2, 0, 0x1a, 0x0b};  // ref.func 0; drop
+
+class IncrementalValidatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override { features.enable_reference_types(); }
+
+  bool Validate(const std::vector<u8>& data) {
+    ReadCtx read_ctx{features, errors};
+    auto module = ReadModule(data, read_ctx);
+    EXPECT_TRUE(module.has_value());
+    return module && validator.Validate(*module, errors);
+  }
+
+  Features features;
+  TestErrors errors;
+  IncrementalValidator validator{features};
+};
+
+}  // namespace
+
+TEST_F(IncrementalValidatorTest, FirstRunIsFull) {
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop, kNop})));
+  ExpectNoErrors(errors);
+  EXPECT_TRUE(validator.was_full_run);
+  EXPECT_EQ(3u, validator.validated_code_count);
+}
+
+TEST_F(IncrementalValidatorTest, OnlyChangedCodes) {
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop, kNop})));
+  EXPECT_TRUE(Validate(MakeModule({kNop, kDrop, kNop})));
+  ExpectNoErrors(errors);
+  EXPECT_FALSE(validator.was_full_run);
+  EXPECT_EQ(1u, validator.validated_code_count);
+
+  EXPECT_TRUE(Validate(MakeModule({kNop, kDrop, kNop})));
+  EXPECT_FALSE(validator.was_full_run);
+  EXPECT_EQ(0u, validator.validated_code_count);
+}
+
+TEST_F(IncrementalValidatorTest, InvalidCode) {
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop})));
+  EXPECT_FALSE(Validate(MakeModule({kNop, kLeftover})));
+  EXPECT_FALSE(validator.was_full_run);
+  EXPECT_EQ(1u, validator.validated_code_count);
+  EXPECT_FALSE(errors.errors.empty());
+  errors.Clear();
+
+  // Nothing is kept from an invalid module.
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop})));
+  ExpectNoErrors(errors);
+  EXPECT_TRUE(validator.was_full_run);
+  EXPECT_EQ(2u, validator.validated_code_count);
+}
+
+TEST_F(IncrementalValidatorTest, DeclarationsChanged) {
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop})));
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop, kNop})));
+  ExpectNoErrors(errors);
+  EXPECT_TRUE(validator.was_full_run);
+  EXPECT_EQ(3u, validator.validated_code_count);
+}
+
+TEST_F(IncrementalValidatorTest, DeclaredFunctionsChanged) {
+  // The export declares function 0, so ref.func 0 is valid.
+  EXPECT_TRUE(Validate(MakeModule({kRefFunc, kNop}, 0, 1)));
+  ExpectNoErrors(errors);
+
+  // Exporting another function revalidates all code entries.
+  EXPECT_TRUE(Validate(MakeModule({kRefFunc, kNop}, 0, 2)));
+  ExpectNoErrors(errors);
+  EXPECT_FALSE(validator.was_full_run);
+  EXPECT_EQ(2u, validator.validated_code_count);
+
+  // Without the export, the unchanged ref.func 0 is now invalid.
+  EXPECT_FALSE(Validate(MakeModule({kRefFunc, kNop})));
+  EXPECT_FALSE(validator.was_full_run);
+  EXPECT_FALSE(errors.errors.empty());
+}
+
+TEST_F(IncrementalValidatorTest, Reset) {
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop})));
+  validator.Reset();
+  EXPECT_TRUE(Validate(MakeModule({kNop, kNop})));
+  EXPECT_TRUE(validator.was_full_run);
+  EXPECT_EQ(2u, validator.validated_code_count);
+}
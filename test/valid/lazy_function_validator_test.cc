@@ -0,0 +1,141 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/lazy_function_validator.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/buffered_errors.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/code_index.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/valid/validate_visitor.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+using namespace ::wasp::valid;
+
+namespace {
+
+const std::vector<u8> kNop = {0, 0x01, 0x0b};         // nop
+const std::vector<u8> kLeftover = {0, 0x41, 0, 0x0b};  // i32.const 0
+const std::vector<u8> kUnknown = {0, 0xff};           // unknown opcode
+// block; i32.const 0; br_if 0; end
+const std::vector<u8> kBrIf = {0, 0x02, 0x40, 0x41, 0, 0x0d, 0, 0x0b, 0x0b};
+
+}  // namespace
+
+TEST(LazyFunctionValidatorTest, Basic) {
+  const auto data = MakeModule({kNop, kLeftover, kUnknown}, 1);
+
+  TestErrors errors;
+  auto module = ReadLazyModule(data, Features{}, errors);
+  auto code_index = ReadCodeIndex(module);
+  ValidateVisitor visitor{Features{}, errors};
+  visitor.skip_codes = true;
+  EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+  ExpectNoErrors(errors);
+  EXPECT_EQ(0u, visitor.ctx.code_count);
+
+  LazyFunctionValidator validator{visitor.ctx, code_index};
+  EXPECT_EQ(3u, validator.code_index().size());
+
+  // The imported function.
+  EXPECT_TRUE(validator.ValidateFunction(0, errors));
+
+  EXPECT_EQ(nullopt, validator.GetResult(1));
+  EXPECT_TRUE(validator.ValidateFunction(1, errors));
+  EXPECT_EQ(optional<bool>{true}, validator.GetResult(1));
+  ExpectNoErrors(errors);
+
+  EXPECT_FALSE(validator.ValidateFunction(2, errors));
+  EXPECT_EQ(1u, errors.errors.size());
+  EXPECT_FALSE(validator.ValidateFunction(3, errors));
+  const auto error_count = errors.errors.size();
+  EXPECT_LT(1u, error_count);
+
+  // The results are cached, and the errors are not reported again.
+  EXPECT_FALSE(validator.ValidateFunction(2, errors));
+  EXPECT_EQ(optional<bool>{false}, validator.GetResult(3));
+  EXPECT_EQ(error_count, errors.errors.size());
+
+  EXPECT_FALSE(validator.ValidateFunction(4, errors));
+  EXPECT_EQ(nullopt, validator.GetResult(4));
+  EXPECT_EQ(error_count, errors.errors.size());
+}
+
+TEST(LazyFunctionValidatorTest, Threads) {
+  std::vector<std::vector<u8>> bodies(50, kNop);
+  bodies[20] = kLeftover;
+  const auto data = MakeModule(bodies, 1);
+
+  TestErrors errors;
+  auto module = ReadLazyModule(data, Features{}, errors);
+  auto code_index = ReadCodeIndex(module);
+  ValidateVisitor visitor{Features{}, errors};
+  visitor.skip_codes = true;
+  EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+  ExpectNoErrors(errors);
+
+  LazyFunctionValidator validator{visitor.ctx, code_index};
+  // Every thread validates every function, sharing one Errors object.
+  BufferedErrors shared_errors;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (Index func_index = 1; func_index <= 50; ++func_index) {
+        EXPECT_EQ(func_index != 21,
+                  validator.ValidateFunction(func_index, shared_errors));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The error is only reported once.
+  shared_errors.ReplayInto(errors);
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(LazyFunctionValidatorTest, VisitorSideTables) {
+  const auto data = MakeModule({kNop, kBrIf}, 1);
+
+  TestErrors errors;
+  auto module = ReadLazyModule(data, Features{}, errors);
+  auto code_index = ReadCodeIndex(module);
+  ValidateVisitor visitor{Features{}, errors};
+  visitor.build_side_tables = true;
+  visitor.collect_function_stats = true;
+  EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+  ExpectNoErrors(errors);
+  ASSERT_EQ(2u, visitor.side_tables.size());
+  ASSERT_EQ(2u, visitor.function_stats.size());
+
+  // The visitor's ValidCtx still refers to its last side table and stats,
+  // but the validator must not write to them.
+  LazyFunctionValidator validator{visitor.ctx, code_index};
+  EXPECT_TRUE(validator.ValidateFunction(2, errors));
+  EXPECT_TRUE(validator.ValidateFunction(1, errors));
+  ExpectNoErrors(errors);
+  EXPECT_EQ(1u, visitor.side_tables[1].entries.size());
+  EXPECT_EQ(5u, visitor.function_stats[1].instruction_count);
+}
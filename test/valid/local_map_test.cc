@@ -29,42 +29,52 @@ void ExpectTypes(const LocalMap& locals,
   ASSERT_EQ(value_types.size(), locals.GetCount());
   for (Index i = 0; i < value_types.size(); ++i) {
     const auto& value_type = value_types[i];
-    EXPECT_EQ(value_type, locals.GetType(i)) << "at index " << i;
+    auto type = locals.GetType(i);
+    ASSERT_TRUE(type.has_value()) << "at index " << i;
+    EXPECT_EQ(StackType{value_type}, StackType{*type}) << "at index " << i;
+    EXPECT_EQ(StackType{value_type}, locals.GetStackType(i))
+        << "at index " << i;
   }
   EXPECT_EQ(nullopt, locals.GetType(locals.GetCount() + 1));
+  EXPECT_EQ(nullopt, locals.GetStackType(locals.GetCount()));
 }
 
 TEST(ValidLocalMapTest, Append_CountType) {
   LocalMap locals;
-  EXPECT_TRUE(locals.Append(1, VT_I32));
-  EXPECT_TRUE(locals.Append(2, VT_F32));
-  EXPECT_TRUE(locals.Append(3, VT_I64));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
+  EXPECT_TRUE(locals.Append(2, StackType::F32()));
+  EXPECT_TRUE(locals.Append(3, StackType::I64()));
 
   ExpectTypes(locals, {VT_I32, VT_F32, VT_F32, VT_I64, VT_I64, VT_I64});
 }
 
 TEST(ValidLocalMapTest, Append_ValueTypeList) {
   LocalMap locals;
-  EXPECT_TRUE(locals.Append({VT_I32, VT_F32, VT_F32, VT_I64, VT_I64, VT_I32}));
+  EXPECT_TRUE(locals.Append({StackType::I32(), StackType::F32(),
+                             StackType::F32(), StackType::I64(),
+                             StackType::I64(), StackType::I32()}));
 
   ExpectTypes(locals, {VT_I32, VT_F32, VT_F32, VT_I64, VT_I64, VT_I32});
 }
 
 TEST(ValidLocalMapTest, Append_TooMany) {
   LocalMap locals;
-  EXPECT_TRUE(locals.Append(0xffff'ffff, VT_I64)); // Maximum is 2**32 - 1.
+  // Maximum is 2**32 - 1.
+  EXPECT_TRUE(locals.Append(0xffff'ffff, StackType::I64()));
 
-  EXPECT_EQ(VT_I64, locals.GetType(0xffff'fffe));
+  EXPECT_EQ(StackType::I64(), StackType{*locals.GetType(0xffff'fffe)});
   EXPECT_EQ(nullopt, locals.GetType(0xffff'ffff));
+  EXPECT_EQ(StackType::I64(), locals.GetStackType(0xffff'fffe));
+  EXPECT_EQ(nullopt, locals.GetStackType(0xffff'ffff));
 
-  EXPECT_FALSE(locals.Append(1, VT_I32));
-  EXPECT_FALSE(locals.Append({VT_I32}));
+  EXPECT_FALSE(locals.Append(1, StackType::I32()));
+  EXPECT_FALSE(locals.Append({StackType::I32()}));
 }
 
 TEST(ValidLocalMapTest, Reset) {
   LocalMap locals;
-  EXPECT_TRUE(locals.Append(100, VT_I32));
-  EXPECT_TRUE(locals.Append({VT_F32, VT_I64}));
+  EXPECT_TRUE(locals.Append(100, StackType::I32()));
+  EXPECT_TRUE(locals.Append({StackType::F32(), StackType::I64()}));
 
   EXPECT_EQ(102u, locals.GetCount());
 
@@ -77,11 +87,11 @@ TEST(ValidLocalMapTest, Reset) {
 TEST(ValidLocalMapTest, PushPop) {
   LocalMap locals;
 
-  EXPECT_TRUE(locals.Append(2, VT_I32));
+  EXPECT_TRUE(locals.Append(2, StackType::I32()));
   ExpectTypes(locals, {VT_I32, VT_I32});
 
   locals.Push();
-  EXPECT_TRUE(locals.Append(2, VT_F32));
+  EXPECT_TRUE(locals.Append(2, StackType::F32()));
   ExpectTypes(locals, {VT_F32, VT_F32, VT_I32, VT_I32});
 
   locals.Pop();
@@ -91,16 +101,16 @@ TEST(ValidLocalMapTest, PushPop) {
 TEST(ValidLocalMapTest, PushPop_SameType) {
   LocalMap locals;
 
-  EXPECT_TRUE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
   ExpectTypes(locals, {VT_I32});
 
-  EXPECT_TRUE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
   ExpectTypes(locals, {VT_I32, VT_I32});
 
   // Push a let block, then append the same type. Make sure that popping
   // afterward still works.
   locals.Push();
-  EXPECT_TRUE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
   ExpectTypes(locals, {VT_I32, VT_I32, VT_I32});
 
   locals.Pop();
@@ -110,19 +120,19 @@ TEST(ValidLocalMapTest, PushPop_SameType) {
 TEST(ValidLocalMapTest, PushPop_Multi) {
   LocalMap locals;
 
-  EXPECT_TRUE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
   ExpectTypes(locals, {VT_I32});
 
   locals.Push();
-  EXPECT_TRUE(locals.Append(1, VT_F32));
+  EXPECT_TRUE(locals.Append(1, StackType::F32()));
   ExpectTypes(locals, {VT_F32, VT_I32});
 
   // Push a let block, then append twice. The second append should come after
   // the first.
   locals.Push();
-  EXPECT_TRUE(locals.Append(1, VT_F64));
+  EXPECT_TRUE(locals.Append(1, StackType::F64()));
   ExpectTypes(locals, {VT_F64, VT_F32, VT_I32});
-  EXPECT_TRUE(locals.Append(1, VT_I64));
+  EXPECT_TRUE(locals.Append(1, StackType::I64()));
   ExpectTypes(locals, {VT_F64, VT_I64, VT_F32, VT_I32});
 
   locals.Pop();
@@ -135,12 +145,12 @@ TEST(ValidLocalMapTest, PushPop_Multi) {
 TEST(ValidLocalMapTest, PushPop_TooMany) {
   LocalMap locals;
 
-  EXPECT_TRUE(locals.Append(100, VT_I32));
+  EXPECT_TRUE(locals.Append(100, StackType::I32()));
   EXPECT_EQ(100u, locals.GetCount());
 
   locals.Push();
-  EXPECT_TRUE(locals.Append(0xffff'ffff - 100, VT_I32));
-  EXPECT_FALSE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(0xffff'ffff - 100, StackType::I32()));
+  EXPECT_FALSE(locals.Append(1, StackType::I32()));
 
   locals.Pop();
   EXPECT_EQ(100u, locals.GetCount());
@@ -151,11 +161,11 @@ TEST(ValidLocalMapTest, PopToEmpty) {
   ExpectTypes(locals, {});
 
   locals.Push();
-  EXPECT_TRUE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
   ExpectTypes(locals, {VT_I32});
 
   locals.Push();
-  EXPECT_TRUE(locals.Append(1, VT_I32));
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
   ExpectTypes(locals, {VT_I32, VT_I32});
 
   locals.Pop();
@@ -164,3 +174,56 @@ TEST(ValidLocalMapTest, PopToEmpty) {
   locals.Pop();
   ExpectTypes(locals, {});
 }
+
+TEST(ValidLocalMapTest, DenseLimit) {
+  LocalMap locals{4};
+
+  EXPECT_TRUE(locals.Append(3, StackType::I32()));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_I32});
+
+  // Going over the limit switches to the run-length form only.
+  EXPECT_TRUE(locals.Append(2, StackType::F32()));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_I32, VT_F32, VT_F32});
+
+  locals.Reset();
+  EXPECT_TRUE(locals.Append(1, StackType::I32()));
+  ExpectTypes(locals, {VT_I32});
+}
+
+TEST(ValidLocalMapTest, DenseLimit_PushPop) {
+  LocalMap locals{4};
+
+  EXPECT_TRUE(locals.Append(2, StackType::I32()));
+  ExpectTypes(locals, {VT_I32, VT_I32});
+
+  locals.Push();
+  EXPECT_TRUE(locals.Append(1, StackType::F32()));
+  ExpectTypes(locals, {VT_F32, VT_I32, VT_I32});
+
+  // Goes over the limit.
+  locals.Push();
+  EXPECT_TRUE(locals.Append(2, StackType::I64()));
+  ExpectTypes(locals, {VT_I64, VT_I64, VT_F32, VT_I32, VT_I32});
+
+  // Back under the limit, so the dense table is rebuilt.
+  locals.Pop();
+  ExpectTypes(locals, {VT_F32, VT_I32, VT_I32});
+
+  locals.Pop();
+  ExpectTypes(locals, {VT_I32, VT_I32});
+}
+
+TEST(ValidLocalMapTest, DenseLimit_Zero) {
+  LocalMap locals{0};
+
+  EXPECT_TRUE(
+      locals.Append({StackType::I32(), StackType::F32(), StackType::F32()}));
+  ExpectTypes(locals, {VT_I32, VT_F32, VT_F32});
+
+  locals.Push();
+  EXPECT_TRUE(locals.Append(1, StackType::I64()));
+  ExpectTypes(locals, {VT_I64, VT_I32, VT_F32, VT_F32});
+
+  locals.Pop();
+  ExpectTypes(locals, {VT_I32, VT_F32, VT_F32});
+}
@@ -211,6 +211,34 @@ TEST_F(ValidMatchTest, IsSame_Rtt) {
   IsSameDistinct(rtts);
 }
 
+TEST_F(ValidMatchTest, IsSame_StackType_DeepRtt) {
+  // Rtt depths that don't fit in the packed StackType are still compared by
+  // value.
+  const Index deep = StackType::kMaxRttDepth + 1;
+  auto rtt = [&](Index depth, HeapType heap_type, DeepRttTable& table) {
+    return StackType{ValueType{Rtt{depth, heap_type}}, table};
+  };
+  StackType rtt_deep = rtt(deep, HT_Func, ctx.deep_rtts);
+  StackType rtt_deeper = rtt(deep + 1, HT_Func, ctx.deep_rtts);
+  StackType rtt_max = rtt(StackType::kMaxRttDepth, HT_Func, ctx.deep_rtts);
+
+  EXPECT_TRUE(IsSame(ctx, rtt_deep, rtt(deep, HT_Func, ctx.deep_rtts)));
+  EXPECT_FALSE(IsSame(ctx, rtt_deep, rtt_deeper));
+  EXPECT_FALSE(IsSame(ctx, rtt_max, rtt_deep));
+
+  // IsMatch ignores the depth, but not the heap type.
+  StackType rtt_deep_extern = rtt(deep, HT_Extern, ctx.deep_rtts);
+  EXPECT_TRUE(IsMatch(ctx, rtt_deep, rtt_deeper));
+  EXPECT_FALSE(IsMatch(ctx, rtt_deep, rtt_deep_extern));
+
+  // Types from another context's table have different bits, but are still
+  // the same.
+  DeepRttTable other;
+  EXPECT_NE(rtt_deep, rtt(deep, HT_Func, other));
+  EXPECT_TRUE(IsSame(ctx, rtt_deep, rtt(deep, HT_Func, other)));
+  EXPECT_FALSE(IsSame(ctx, rtt_deep, rtt(deep + 1, HT_Func, other)));
+}
+
 TEST_F(ValidMatchTest, IsSame_ValueType_Simple) {
   std::vector<ValueType> types{
       VT_I32,       VT_I64,           VT_F32,       VT_F64,
@@ -265,7 +293,6 @@ TEST_F(ValidMatchTest, IsSame_ValueType_Simple) {
 }
 
 TEST_F(ValidMatchTest, IsSame_ValueType_Var) {
-  ctx.same_types.Reset(3);
   PushFunctionType({VT_F32}, {});  // 0
   PushFunctionType({VT_F32}, {});  // 1
   PushFunctionType({VT_I32}, {});  // 2
@@ -276,7 +303,6 @@ TEST_F(ValidMatchTest, IsSame_ValueType_Var) {
 }
 
 TEST_F(ValidMatchTest, IsSame_ValueType_VarRecursive) {
-  ctx.same_types.Reset(3);
   PushFunctionType({}, {VT_Ref0});        // 0
   PushFunctionType({}, {VT_Ref1});        // 1
   PushFunctionType({VT_I32}, {VT_Ref0});  // 2
@@ -287,7 +313,6 @@ TEST_F(ValidMatchTest, IsSame_ValueType_VarRecursive) {
 }
 
 TEST_F(ValidMatchTest, IsSame_ValueType_VarMutuallyRecursive) {
-  ctx.same_types.Reset(3);
   PushFunctionType({VT_I32}, {VT_Ref0});  // 0
   PushFunctionType({VT_I32}, {VT_Ref2});  // 1
   PushFunctionType({VT_I32}, {VT_Ref1});  // 2
@@ -676,6 +701,18 @@ TEST_F(ValidMatchTest, IsMatch_StructType_Subtyping) {
                           FieldType{StorageType{VT_I32}, Mutability::Var}}}));
 }
 
+TEST_F(ValidMatchTest, IsMatch_ValueType_VarSubtyping) {
+  FieldType i32_field{StorageType{VT_I32}, Mutability::Const};
+  PushStructType(StructType{FieldTypeList{i32_field}});             // 0
+  PushStructType(StructType{FieldTypeList{i32_field, i32_field}});  // 1
+
+  // Subtyping is not symmetric, so a cached result for one direction must
+  // not be used for the other.
+  EXPECT_TRUE(IsMatch(ctx, VT_Ref0, VT_Ref1));
+  EXPECT_FALSE(IsMatch(ctx, VT_Ref1, VT_Ref0));
+  EXPECT_TRUE(IsMatch(ctx, VT_Ref0, VT_Ref1));
+}
+
 TEST_F(ValidMatchTest, IsMatch_ArrayType_Simple) {
   std::vector<ArrayType> types{
       ArrayType{FieldType{StorageType{VT_I32}, Mutability::Const}},
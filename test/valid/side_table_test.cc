@@ -0,0 +1,156 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/side_table.h"
+
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/valid/test_utils.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/valid/valid_ctx.h"
+#include "wasp/valid/validate.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::valid;
+using namespace ::wasp::test;
+using namespace ::wasp::valid::test;
+
+namespace {
+
+using Entry = std::tuple<u32, u32, u32, u32>;
+
+// Validates `code`, a code entry with no locals, as a function of type
+// `function_type`, and returns its side table.
+std::vector<Entry> Build(const FunctionType& function_type,
+                         const std::vector<u8>& code) {
+  TestErrors errors;
+  ValidCtx ctx{errors};
+  ctx.types.push_back(DefinedType{function_type});
+  ctx.defined_type_count = 1;
+  ctx.functions.push_back(Function{0});
+
+  SideTable side_table;
+  ctx.side_table = &side_table;
+
+  SpanU8 data{code};
+  EXPECT_TRUE(BeginCode(ctx, data));
+  ReadCtx read_ctx{Features{}, errors};
+  for (auto&& instr : ReadExpression(data.subspan(1), read_ctx)) {
+    EXPECT_TRUE(Validate(ctx, instr));
+  }
+  ExpectNoErrors(errors);
+
+  std::vector<Entry> result;
+  for (const auto& entry : side_table.entries) {
+    result.emplace_back(entry.offset, entry.target_offset, entry.value_count,
+                        entry.drop_count);
+  }
+  return result;
+}
+
+const FunctionType kVoid{};
+const FunctionType kI32{{}, {ValueType::I32_NoLocation()}};
+
+}  // namespace
+
+TEST(ValidSideTableTest, Block) {
+  EXPECT_EQ((std::vector<Entry>{{5, 8, 0, 0}}),
+            Build(kVoid, {
+                             0x00,        //  0: (no locals)
+                             0x02, 0x40,  //  1: block
+                             0x41, 0x00,  //  3:   i32.const 0
+                             0x0d, 0x00,  //  5:   br_if 0
+                             0x0b,        //  7: end
+                             0x0b,        //  8: end
+                         }));
+}
+
+TEST(ValidSideTableTest, Loop) {
+  EXPECT_EQ((std::vector<Entry>{{5, 3, 0, 0}}),
+            Build(kVoid, {
+                             0x00,        //  0: (no locals)
+                             0x03, 0x40,  //  1: loop
+                             0x41, 0x01,  //  3:   i32.const 1
+                             0x0d, 0x00,  //  5:   br_if 0
+                             0x0b,        //  7: end
+                             0x0b,        //  8: end
+                         }));
+}
+
+TEST(ValidSideTableTest, IfElse) {
+  EXPECT_EQ((std::vector<Entry>{{3, 8, 0, 0}, {7, 11, 1, 0}}),
+            Build(kI32, {
+                            0x00,        //  0: (no locals)
+                            0x41, 0x01,  //  1: i32.const 1
+                            0x04, 0x7f,  //  3: if (result i32)
+                            0x41, 0x02,  //  5:   i32.const 2
+                            0x05,        //  7: else
+                            0x41, 0x03,  //  8:   i32.const 3
+                            0x0b,        // 10: end
+                            0x0b,        // 11: end
+                        }));
+}
+
+TEST(ValidSideTableTest, IfNoElse) {
+  EXPECT_EQ((std::vector<Entry>{{3, 7, 0, 0}}),
+            Build(kVoid, {
+                             0x00,        //  0: (no locals)
+                             0x41, 0x01,  //  1: i32.const 1
+                             0x04, 0x40,  //  3: if
+                             0x01,        //  5:   nop
+                             0x0b,        //  6: end
+                             0x0b,        //  7: end
+                         }));
+}
+
+TEST(ValidSideTableTest, BrTable_Return) {
+  EXPECT_EQ((std::vector<Entry>{
+                {11, 16, 1, 1},  // br_table target 0
+                {11, 17, 1, 1},  // br_table default target
+                {17, 19, 1, 0},  // return
+            }),
+            Build(kI32, {
+                            0x00,                    //  0: (no locals)
+                            0x02, 0x7f,              //  1: block (result i32)
+                            0x02, 0x7f,              //  3:   block (result i32)
+                            0x41, 0x07,              //  5:     i32.const 7
+                            0x41, 0x08,              //  7:     i32.const 8
+                            0x41, 0x00,              //  9:     i32.const 0
+                            0x0e, 0x01, 0x00, 0x01,  // 11:     br_table 0 1
+                            0x0b,                    // 15:   end
+                            0x0b,                    // 16: end
+                            0x0f,                    // 17: return
+                            0x0b,                    // 18: end
+                        }));
+}
+
+TEST(ValidSideTableTest, Find) {
+  SideTable side_table;
+  side_table.entries = {{1, 10, 0, 0}, {4, 10, 0, 0}, {4, 12, 0, 0}};
+
+  EXPECT_EQ(0u, side_table.Find(0).size());
+  EXPECT_EQ(1u, side_table.Find(1).size());
+  EXPECT_EQ(0u, side_table.Find(2).size());
+
+  auto entries = side_table.Find(4);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(10u, entries[0].target_offset);
+  EXPECT_EQ(12u, entries[1].target_offset);
+}
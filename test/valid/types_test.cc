@@ -0,0 +1,107 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/types.h"
+
+#include "gtest/gtest.h"
+
+#include "test/binary/constants.h"
+#include "wasp/base/concat.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/valid/formatters.h"
+
+using namespace ::wasp;
+using namespace ::wasp::valid;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+const ValueType kValueTypes[] = {
+    VT_I32, VT_I64, VT_F32, VT_F64, VT_V128, VT_Funcref, VT_Externref,
+    VT_Anyref, VT_Eqref, VT_Exnref, VT_I31ref, VT_RefFunc, VT_RefNullFunc,
+    VT_RefExtern, VT_RefNullExtern, VT_RefAny, VT_RefNullAny, VT_RefEq,
+    VT_RefNullEq, VT_RefExn, VT_RefNullExn, VT_RefI31, VT_RefNullI31, VT_Ref0,
+    VT_RefNull0, VT_Ref1, VT_RefNull1, VT_Ref2, VT_RefNull2, VT_RTT_0_Func,
+    VT_RTT_0_Extern, VT_RTT_0_Exn, VT_RTT_0_Eq, VT_RTT_0_I31, VT_RTT_0_Any,
+    VT_RTT_0_0, VT_RTT_1_Func, VT_RTT_1_Extern, VT_RTT_1_Exn, VT_RTT_1_Eq,
+    VT_RTT_1_I31, VT_RTT_1_Any, VT_RTT_1_0,
+};
+
+}  // namespace
+
+TEST(ValidTypesTest, StackType_RoundTrip) {
+  for (const auto& value_type : kValueTypes) {
+    StackType stack_type{value_type};
+    EXPECT_TRUE(stack_type.is_value_type());
+    EXPECT_FALSE(stack_type.is_any());
+    EXPECT_EQ(value_type.is_numeric_type(), stack_type.is_numeric_type());
+    EXPECT_EQ(value_type.is_reference_type(), stack_type.is_reference_type());
+    EXPECT_EQ(value_type.is_rtt(), stack_type.is_rtt());
+    // The decoded type has no locations, so compare the formatted types.
+    EXPECT_EQ(concat(value_type), concat(stack_type.value_type()));
+  }
+}
+
+TEST(ValidTypesTest, StackType_Distinct) {
+  for (const auto& lhs : kValueTypes) {
+    for (const auto& rhs : kValueTypes) {
+      EXPECT_EQ(lhs == rhs, StackType{lhs} == StackType{rhs})
+          << lhs << " vs. " << rhs;
+    }
+    EXPECT_NE(StackType{Any{}}, StackType{lhs});
+  }
+}
+
+TEST(ValidTypesTest, StackType_Any) {
+  EXPECT_TRUE(StackType{}.is_any());
+  EXPECT_TRUE(StackType{Any{}}.is_any());
+  EXPECT_FALSE(StackType{Any{}}.is_value_type());
+  EXPECT_EQ(StackType{}, StackType{Any{}});
+}
+
+TEST(ValidTypesTest, StackType_IgnoresLocation) {
+  const u8 data[] = {0};
+  Location loc{data, 1};
+  auto i32 = ValueType{At{loc, NumericType::I32}};
+  auto ref0 = ValueType{ReferenceType{
+      At{loc, RefType{HeapType{At{loc, Index{0}}}, Null::No}}}};
+
+  EXPECT_EQ(StackType::I32(), StackType{i32});
+  EXPECT_EQ(StackType{VT_Ref0}, StackType{ref0});
+}
+
+TEST(ValidTypesTest, StackType_RttDepth) {
+  DeepRttTable table;
+  auto rtt = [&](Index depth) {
+    return StackType{ValueType{Rtt{depth, HT_Func}}, table};
+  };
+
+  EXPECT_EQ(StackType::kMaxRttDepth,
+            rtt(StackType::kMaxRttDepth).value_type().rtt()->depth);
+  EXPECT_NE(rtt(StackType::kMaxRttDepth - 1), rtt(StackType::kMaxRttDepth));
+
+  // Larger depths are stored in the table, and are shared within it.
+  const Index deep = StackType::kMaxRttDepth + 1;
+  EXPECT_EQ(deep, rtt(deep).value_type().rtt()->depth);
+  EXPECT_EQ(0xffffffff, rtt(0xffffffff).value_type().rtt()->depth);
+  EXPECT_EQ(rtt(deep), rtt(deep));
+  EXPECT_NE(rtt(deep), rtt(0xffffffff));
+  EXPECT_NE(rtt(StackType::kMaxRttDepth), rtt(deep));
+  auto deep_rtt0 = ValueType{Rtt{deep, HT_0}};
+  EXPECT_EQ(StackType(deep_rtt0, table),
+            StackType(StackType(deep_rtt0, table).value_type(), table));
+}
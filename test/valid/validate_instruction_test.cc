@@ -15,6 +15,7 @@
 //
 
 #include <cassert>
+#include <iterator>
 
 #include "gtest/gtest.h"
 #include "test/binary/constants.h"
@@ -65,8 +66,6 @@ class ValidateInstructionTest : public ::testing::Test {
 
   void IncrementDefinedTypeCount() {
     ctx.defined_type_count++;
-    ctx.same_types.Reset(ctx.defined_type_count);
-    ctx.match_types.Reset(ctx.defined_type_count);
   }
 
   Index AddFunctionType(const FunctionType& function_type) {
@@ -114,7 +113,7 @@ class ValidateInstructionTest : public ::testing::Test {
   }
 
   Index AddLocal(const ValueType& value_type) {
-    bool ok = ctx.locals.Append(1, value_type);
+    bool ok = ctx.locals.Append(1, StackType{value_type, ctx.deep_rtts});
     WASP_USE(ok);
     assert(ok);
     return ctx.locals.GetCount() - 1;
@@ -151,10 +150,10 @@ class ValidateInstructionTest : public ::testing::Test {
     TestErrors errors;
     ValidCtx context_copy{ctx, errors};
     context_copy.label_stack.back().unreachable = true;
-    context_copy.type_stack = ToStackTypeList(param_types);
+    context_copy.type_stack = ToStackTypeList(param_types, ctx.deep_rtts);
     EXPECT_TRUE(Validate(context_copy, instruction)) << instruction;
-    EXPECT_TRUE(
-        IsSame(ctx, ToStackTypeList(result_types), context_copy.type_stack))
+    EXPECT_TRUE(IsSame(ctx, ToStackTypeList(result_types, ctx.deep_rtts),
+                       context_copy.type_stack))
         << instruction;
     ExpectNoErrors(errors);
   }
@@ -170,15 +169,18 @@ class ValidateInstructionTest : public ::testing::Test {
 
   void FailWithTypeStack(const Instruction& instruction,
                          const ValueTypeList& param_types) {
-    FailWithTypeStack(instruction, ToStackTypeList(param_types));
+    FailWithTypeStack(instruction,
+                      ToStackTypeList(param_types, ctx.deep_rtts));
   }
 
 
   void TestSignatureNoUnreachable(const Instruction& instruction,
                                   const ValueTypeList& param_types,
                                   const ValueTypeList& result_types) {
-    const StackTypeList stack_param_types = ToStackTypeList(param_types);
-    const StackTypeList stack_result_types = ToStackTypeList(result_types);
+    const StackTypeList stack_param_types =
+        ToStackTypeList(param_types, ctx.deep_rtts);
+    const StackTypeList stack_result_types =
+        ToStackTypeList(result_types, ctx.deep_rtts);
 
     // Test that it is only valid when the full list of parameters is on the
     // stack.
@@ -256,6 +258,22 @@ TEST_F(ValidateInstructionTest, Block_SingleResult) {
   ExpectNoErrors(errors);
 }
 
+TEST_F(ValidateInstructionTest, Block_SingleResult_Nested) {
+  // Keep every label alive while new block signatures are added, to check
+  // that the label types remain valid.
+  for (const auto& info : all_value_types) {
+    Ok(I{O::Block, info.block_type});
+    Ok(info.instruction);
+  }
+  for (size_t i = 0; i < std::size(all_value_types); ++i) {
+    if (i != 0) {
+      Ok(I{O::Drop});
+    }
+    Ok(I{O::End});
+  }
+  ExpectNoErrors(errors);
+}
+
 TEST_F(ValidateInstructionTest, Block_MultiResult) {
   auto index = AddFunctionType(FunctionType{{}, {VT_I32, VT_F32}});
   Ok(I{O::Block, BlockType(index)});
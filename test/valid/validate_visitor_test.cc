@@ -0,0 +1,213 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_visitor.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/stream_decoder.h"
+#include "wasp/binary/visitor.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+using namespace ::wasp::valid;
+
+namespace {
+
+const std::vector<u8> kNop = {0, 0x01, 0x0b};         // nop
+const std::vector<u8> kLeftover = {0, 0x41, 0, 0x0b};  // i32.const 0
+const std::vector<u8> kUnknown = {0, 0xff};           // unknown opcode
+const std::vector<u8> kBadLocals = {5, 1};            // truncated locals
+// block; i32.const 0; br_if 0; end
+const std::vector<u8> kBrIf = {0, 0x02, 0x40, 0x41, 0, 0x0d, 0, 0x0b, 0x0b};
+// (local i32 i32) local.get 0; local.tee 1; drop; call 0
+const std::vector<u8> kLocals = {
+    1, 2, 0x7f, 0x20, 0, 0x22, 1, 0x1a, 0x10, 0, 0x0b};
+
+}  // namespace
+
+TEST(ValidateVisitorTest, Parallel) {
+  // Enough functions that they are split across several threads, and that the
+  // function count needs a multi-byte LEB128.
+  const auto data = MakeModule(std::vector<std::vector<u8>>(300, kNop));
+
+  for (int jobs : {1, 4}) {
+    TestErrors errors;
+    auto module = ReadLazyModule(data, Features{}, errors);
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+    ExpectNoErrors(errors);
+    EXPECT_EQ(300u, visitor.ctx.code_count);
+  }
+}
+
+TEST(ValidateVisitorTest, Parallel_Errors) {
+  // Validation stops at the first failing function, so the errors for the
+  // later functions are never reported, no matter how many threads are used.
+  std::vector<std::vector<u8>> bodies(40, kNop);
+  bodies[20] = kLeftover;
+  bodies[30] = kUnknown;
+  bodies[35] = kLeftover;
+  const auto data = MakeModule(bodies);
+
+  const std::vector<ExpectedError> expected = {
+      {{145, "instruction"}, {145, "Expected empty stack, got [i32]"}},
+  };
+  for (int jobs : {1, 2, 4}) {
+    TestErrors errors;
+    auto module = ReadLazyModule(data, Features{}, errors);
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    EXPECT_EQ(visit::Result::Fail, visit::Visit(module, visitor));
+    ExpectErrors(expected, errors, data);
+  }
+}
+
+TEST(ValidateVisitorTest, Parallel_CodeHeaderErrors) {
+  std::vector<std::vector<u8>> bodies(40, kNop);
+  bodies[20] = kLeftover;
+  bodies[30] = kBadLocals;
+  const auto data = MakeModule(bodies);
+
+  // The code headers after the first failing function are never read.
+  const std::vector<ExpectedError> expected = {
+      {{145, "instruction"}, {145, "Expected empty stack, got [i32]"}},
+  };
+  for (int jobs : {1, 2, 4}) {
+    TestErrors errors;
+    auto module = ReadLazyModule(data, Features{}, errors);
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    EXPECT_EQ(visit::Result::Fail, visit::Visit(module, visitor));
+    ExpectErrors(expected, errors, data);
+  }
+
+  // Without the failing function, the header errors are reported the same
+  // way as by the serial visitor.
+  bodies[20] = kNop;
+  const auto data2 = MakeModule(bodies);
+  TestErrors serial_errors;
+  {
+    auto module = ReadLazyModule(data2, Features{}, serial_errors);
+    ValidateVisitor visitor{Features{}, serial_errors};
+    EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+    EXPECT_EQ(30u, visitor.ctx.code_count);
+  }
+  ASSERT_FALSE(serial_errors.errors.empty());
+  for (int jobs : {2, 4}) {
+    TestErrors errors;
+    auto module = ReadLazyModule(data2, Features{}, errors);
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+    EXPECT_EQ(30u, visitor.ctx.code_count);
+    ExpectErrors(serial_errors.errors, errors);
+  }
+}
+
+TEST(ValidateVisitorTest, Parallel_StreamDecoder) {
+  std::vector<std::vector<u8>> bodies(50, kNop);
+  bodies[30] = kLeftover;
+  const auto data = MakeModule(bodies);
+
+  // The code bodies haven't arrived when the Code section is visited, so they
+  // are validated serially, as they arrive.
+  for (int jobs : {1, 4}) {
+    TestErrors errors;
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    visit::StreamDecoder<ValidateVisitor> decoder{Features{}, errors, visitor};
+    auto result = visit::Result::Ok;
+    for (size_t pos = 0; pos < data.size() && result == visit::Result::Ok;
+         pos += 7) {
+      result = decoder.Append(
+          SpanU8{data}.subspan(pos, std::min<size_t>(7, data.size() - pos)));
+    }
+    EXPECT_EQ(visit::Result::Fail, result);
+    EXPECT_EQ(31u, visitor.ctx.code_count);
+    ASSERT_EQ(1u, errors.errors.size());
+    EXPECT_EQ("Expected empty stack, got [i32]",
+              errors.errors[0].back().message);
+  }
+}
+
+TEST(ValidateVisitorTest, SideTables) {
+  std::vector<std::vector<u8>> bodies(50, kNop);
+  bodies[10] = kBrIf;
+  bodies[40] = kBrIf;
+  const auto data = MakeModule(bodies);
+
+  for (int jobs : {1, 4}) {
+    TestErrors errors;
+    auto module = ReadLazyModule(data, Features{}, errors);
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    visitor.build_side_tables = true;
+    EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+    ExpectNoErrors(errors);
+
+    ASSERT_EQ(50u, visitor.side_tables.size());
+    for (Index i = 0; i < 50; ++i) {
+      const auto& entries = visitor.side_tables[i].entries;
+      if (i == 10 || i == 40) {
+        ASSERT_EQ(1u, entries.size());
+        // Offsets are relative to the start of the code entry, which begins
+        // with its size.
+        EXPECT_EQ(6u, entries[0].offset);
+        EXPECT_EQ(9u, entries[0].target_offset);
+      } else {
+        EXPECT_EQ(0u, entries.size());
+      }
+    }
+  }
+}
+
+TEST(ValidateVisitorTest, FunctionStats) {
+  std::vector<std::vector<u8>> bodies(50, kNop);
+  bodies[10] = kBrIf;
+  bodies[40] = kLocals;
+  const auto data = MakeModule(bodies);
+
+  for (int jobs : {1, 4}) {
+    TestErrors errors;
+    auto module = ReadLazyModule(data, Features{}, errors);
+    ValidateVisitor visitor{Features{}, errors, jobs};
+    visitor.collect_function_stats = true;
+    EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+    ExpectNoErrors(errors);
+
+    ASSERT_EQ(50u, visitor.function_stats.size());
+    const auto& nop = visitor.function_stats[0];
+    EXPECT_EQ(2u, nop.instruction_count);
+    EXPECT_EQ(0u, nop.max_stack_height);
+    EXPECT_EQ(0u, nop.max_label_depth);
+
+    const auto& br_if = visitor.function_stats[10];
+    EXPECT_EQ(5u, br_if.instruction_count);
+    EXPECT_EQ(1u, br_if.max_stack_height);
+    EXPECT_EQ(1u, br_if.max_label_depth);
+
+    const auto& locals = visitor.function_stats[40];
+    EXPECT_EQ(5u, locals.instruction_count);
+    EXPECT_EQ(2u, locals.local_count);
+    EXPECT_EQ(1u, locals.max_stack_height);
+    EXPECT_EQ(1u, locals.local_reads);
+    EXPECT_EQ(1u, locals.local_writes);
+    EXPECT_EQ(1u, locals.calls);
+    EXPECT_EQ(0u, locals.memory_accesses);
+  }
+}